@@ -1,7 +1,11 @@
 #include <audio_io/audio_io.hpp>
 #include <audio_io/private/mixing_matrices.hpp>
 #include <algorithm>
-
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_IO_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace audio_io {
 namespace implementation {
@@ -36,27 +40,167 @@ void mixUnrecognizedInterleaved(int frames, int inputChannels, float* input, int
 	}
 }
 
-//We do these as templates so we can get our money's worth with unrolling and simd and etc.
-template<float* matrix, int inputChannels, int outputChannels>
-void applyMixingMatrixUninterleaved(int frames, float** inputs, float** outputs) {
-	float frame[inputChannels];
-	for(int i = 0; i < frames; i++) {
-		for(int j = 0; j < inputChannels; j++) frame[j] = inputs[j][i];
-		for(int row = 0; row < outputChannels; row++) {
-			float *curRow = matrix+row*inputChannels;
-			for(int column = 0; column < inputChannels; column++) outputs[row][i] += frame[column]*curRow[column];
+//Mixing matrices are compiled once, for every pair of layouts up to this many channels.
+//Larger layouts use the helpers above.
+const int MAX_COMPILED_CHANNELS = 8;
+
+struct MixingTerm {
+	int column;
+	float coefficient;
+};
+
+struct CompiledMixingMatrix {
+	int input_channels = 0, output_channels = 0;
+	//The nonzero entries, grouped by row: terms[row_starts[r]] to terms[row_starts[r+1]] feed output r.
+	std::vector<MixingTerm> terms;
+	int row_starts[MAX_COMPILED_CHANNELS+1];
+	//Interleaved data is done group_frames frames at a time, chosen so that a group of output fills whole registers.
+	//For input sample j of a group, expanded[j*group_length] is the group of output it feeds: its matrix column, shifted to its frame and zero elsewhere.
+	int group_frames = 0, group_length = 0;
+	std::vector<float> expanded;
+};
+
+constexpr int groupFrames(int outputChannels) {
+	return outputChannels%4 == 0 ? 1 : (outputChannels%2 == 0 ? 2 : 4);
+}
+
+//Builds the matrix for a pair of layouts, following the rules in audio_io.hpp.
+CompiledMixingMatrix compileMixingMatrix(int inputChannels, int outputChannels) {
+	CompiledMixingMatrix m;
+	m.input_channels = inputChannels;
+	m.output_channels = outputChannels;
+	float* matrix = nullptr;
+	for(auto info = mixing_matrix_list; info->pointer; info++) {
+		if((int)info->in_channels == inputChannels && (int)info->out_channels == outputChannels) matrix = info->pointer;
+	}
+	for(int row = 0; row < outputChannels; row++) {
+		m.row_starts[row] = (int)m.terms.size();
+		for(int column = 0; column < inputChannels; column++) {
+			float c;
+			if(matrix) c = matrix[row*inputChannels+column];
+			else if(inputChannels == 1) c = 1.0f;
+			else c = row == column ? 1.0f : 0.0f;
+			if(c == 0.0f) continue;
+			m.terms.push_back({column, c});
+		}
+	}
+	m.row_starts[outputChannels] = (int)m.terms.size();
+	m.group_frames = groupFrames(outputChannels);
+	m.group_length = m.group_frames*outputChannels;
+	m.expanded.assign(m.group_frames*inputChannels*m.group_length, 0.0f);
+	for(int frame = 0; frame < m.group_frames; frame++) {
+		for(int column = 0; column < inputChannels; column++) {
+			int j = frame*inputChannels+column;
+			for(int row = 0; row < outputChannels; row++) {
+				for(int t = m.row_starts[row]; t < m.row_starts[row+1]; t++) {
+					if(m.terms[t].column == column) m.expanded[j*m.group_length+frame*outputChannels+row] = m.terms[t].coefficient;
+				}
+			}
+		}
+	}
+	return m;
+}
+
+const CompiledMixingMatrix& getCompiledMixingMatrix(int inputChannels, int outputChannels) {
+	static std::vector<CompiledMixingMatrix> matrices = [] () {
+		std::vector<CompiledMixingMatrix> built;
+		for(int i = 1; i <= MAX_COMPILED_CHANNELS; i++) {
+			for(int o = 1; o <= MAX_COMPILED_CHANNELS; o++) built.push_back(compileMixingMatrix(i, o));
+		}
+		return built;
+	}();
+	return matrices[(inputChannels-1)*MAX_COMPILED_CHANNELS+outputChannels-1];
+}
+
+//One output channel of uninterleaved data, in one pass over the output.
+void mixRowUninterleaved(int frames, int count, const MixingTerm* terms, float** inputs, float* output, bool zeroFirst) {
+	if(count == 0) {
+		if(zeroFirst) std::fill(output, output+frames, 0.0f);
+		return;
+	}
+	//Mono to n and matching layouts copy when they can.
+	if(count == 1 && terms[0].coefficient == 1.0f) {
+		float* input = inputs[terms[0].column];
+		if(zeroFirst) {
+			std::copy(input, input+frames, output);
+			return;
+		}
+	}
+	int i = 0;
+#if defined(AUDIO_IO_USE_SSE2)
+	__m128 coefficients[MAX_COMPILED_CHANNELS];
+	for(int t = 0; t < count; t++) coefficients[t] = _mm_set1_ps(terms[t].coefficient);
+	for(; i+4 <= frames; i += 4) {
+		__m128 acc = zeroFirst ? _mm_setzero_ps() : _mm_loadu_ps(output+i);
+		for(int t = 0; t < count; t++) acc = _mm_add_ps(acc, _mm_mul_ps(coefficients[t], _mm_loadu_ps(inputs[terms[t].column]+i)));
+		_mm_storeu_ps(output+i, acc);
+	}
+#endif
+	for(; i < frames; i++) {
+		float acc = zeroFirst ? 0.0f : output[i];
+		for(int t = 0; t < count; t++) acc += terms[t].coefficient*inputs[terms[t].column][i];
+		output[i] = acc;
+	}
+}
+
+void applyMixingMatrixUninterleaved(const CompiledMixingMatrix &m, int frames, float** inputs, float** outputs, bool zeroFirst) {
+	for(int row = 0; row < m.output_channels; row++) {
+		mixRowUninterleaved(frames, m.row_starts[row+1]-m.row_starts[row], m.terms.data()+m.row_starts[row], inputs, outputs[row], zeroFirst);
+	}
+}
+
+#if defined(AUDIO_IO_USE_SSE2)
+//Runs whole groups of interleaved frames.  The channel counts are template parameters so that the accumulators stay in registers.
+template<int inputChannels, int outputChannels>
+void applyMixingMatrixGroups(const CompiledMixingMatrix &m, int groups, float* input, float* output, bool zeroFirst) {
+	const int frames = groupFrames(outputChannels), registers = frames*outputChannels/4;
+	const float* expanded = m.expanded.data();
+	for(int group = 0; group < groups; group++) {
+		float* in = input+group*frames*inputChannels;
+		float* out = output+group*frames*outputChannels;
+		__m128 acc[registers];
+		for(int k = 0; k < registers; k++) acc[k] = zeroFirst ? _mm_setzero_ps() : _mm_loadu_ps(out+4*k);
+		for(int frame = 0; frame < frames; frame++) {
+			for(int column = 0; column < inputChannels; column++) {
+				int j = frame*inputChannels+column;
+				__m128 sample = _mm_set1_ps(in[j]);
+				//Only the registers holding this frame.
+				for(int k = frame*outputChannels/4; k < ((frame+1)*outputChannels+3)/4; k++) acc[k] = _mm_add_ps(acc[k], _mm_mul_ps(sample, _mm_loadu_ps(expanded+j*frames*outputChannels+4*k)));
+			}
 		}
+		for(int k = 0; k < registers; k++) _mm_storeu_ps(out+4*k, acc[k]);
 	}
 }
 
-template<float* matrix, int inputChannels, int outputChannels>
-void applyMixingMatrixInterleaved(int frames, float* input, float* output) {
-	float frame[inputChannels];
-	for(int in = 0, out = 0; in < inputChannels*frames; in+=inputChannels, out += outputChannels) {
-		std::copy(input+in, input+in+inputChannels, frame);
+typedef void (*MixingMatrixGroupsFunction)(const CompiledMixingMatrix &m, int groups, float* input, float* output, bool zeroFirst);
+#define GROUPS_ROW(i) {applyMixingMatrixGroups<i, 1>, applyMixingMatrixGroups<i, 2>, applyMixingMatrixGroups<i, 3>, applyMixingMatrixGroups<i, 4>, \
+applyMixingMatrixGroups<i, 5>, applyMixingMatrixGroups<i, 6>, applyMixingMatrixGroups<i, 7>, applyMixingMatrixGroups<i, 8>}
+MixingMatrixGroupsFunction mixing_matrix_groups_functions[MAX_COMPILED_CHANNELS][MAX_COMPILED_CHANNELS] = {
+	GROUPS_ROW(1), GROUPS_ROW(2), GROUPS_ROW(3), GROUPS_ROW(4), GROUPS_ROW(5), GROUPS_ROW(6), GROUPS_ROW(7), GROUPS_ROW(8),
+};
+#undef GROUPS_ROW
+#endif
+
+void applyMixingMatrixInterleaved(const CompiledMixingMatrix &m, int frames, float* input, float* output, bool zeroFirst) {
+	int inputChannels = m.input_channels, outputChannels = m.output_channels;
+	if(inputChannels == outputChannels) {
+		if(zeroFirst) std::copy(input, input+frames*inputChannels, output);
+		else for(int i = 0; i < frames*inputChannels; i++) output[i] += input[i];
+		return;
+	}
+	int frame = 0;
+#if defined(AUDIO_IO_USE_SSE2)
+	int groups = frames/m.group_frames;
+	mixing_matrix_groups_functions[inputChannels-1][outputChannels-1](m, groups, input, output, zeroFirst);
+	frame = groups*m.group_frames;
+#endif
+	for(; frame < frames; frame++) {
+		float* in = input+frame*inputChannels;
+		float* out = output+frame*outputChannels;
 		for(int row = 0; row < outputChannels; row++) {
-			float* curRow = matrix+row*inputChannels;
-			for(int column = 0; column < inputChannels; column++) output[out+row] += curRow[column]*frame[column];
+			float acc = zeroFirst ? 0.0f : out[row];
+			for(int t = m.row_starts[row]; t < m.row_starts[row+1]; t++) acc += m.terms[t].coefficient*in[m.terms[t].column];
+			out[row] = acc;
 		}
 	}
 }
@@ -67,54 +211,22 @@ void applyMixingMatrixInterleaved(int frames, float* input, float* output) {
 using namespace implementation;
 
 void remixAudioInterleaved(int frames, int inputChannels, float* input, int outputChannels, float* output, bool zeroFirst) {
+	if(inputChannels <= MAX_COMPILED_CHANNELS && outputChannels <= MAX_COMPILED_CHANNELS) {
+		applyMixingMatrixInterleaved(getCompiledMixingMatrix(inputChannels, outputChannels), frames, input, output, zeroFirst);
+		return;
+	}
 	if(zeroFirst) std::fill(output, output+frames*outputChannels, 0.0f);
-	if(inputChannels == 1 && outputChannels == 2) applyMixingMatrixInterleaved<mixing_matrix_1_2, 1, 2>(frames, input, output);
-	else if(inputChannels == 1 && outputChannels == 4) applyMixingMatrixInterleaved<mixing_matrix_1_4, 1, 4>(frames, input, output);
-	else if(inputChannels == 1 && outputChannels == 6) applyMixingMatrixInterleaved<mixing_matrix_1_6, 1, 6>(frames, input, output);
-	else if(inputChannels == 1 && outputChannels == 8) applyMixingMatrixInterleaved<mixing_matrix_1_8, 1, 8>(frames, input, output);
-	else if(inputChannels == 1) upmixMonoInterleaved(frames, input, outputChannels, output);
-	else if(inputChannels == 2 && outputChannels == 1) applyMixingMatrixInterleaved<mixing_matrix_2_1, 2, 1>(frames, input, output);
-	else if(inputChannels == 2 && outputChannels == 4) applyMixingMatrixInterleaved<mixing_matrix_2_4, 2, 4>(frames, input, output);
-	else if(inputChannels == 2 && outputChannels == 6) applyMixingMatrixInterleaved<mixing_matrix_2_6, 2, 6>(frames, input, output);
-	else if(inputChannels == 2 && outputChannels == 8) applyMixingMatrixInterleaved<mixing_matrix_2_8, 2, 8>(frames, input, output);
-	else if(inputChannels == 4 && outputChannels == 1) applyMixingMatrixInterleaved<mixing_matrix_4_1, 4, 1>(frames, input, output);
-	else if(inputChannels == 4 && outputChannels == 2) applyMixingMatrixInterleaved<mixing_matrix_4_2, 4, 2>(frames, input, output);
-	else if(inputChannels == 4 && outputChannels == 6) applyMixingMatrixInterleaved<mixing_matrix_4_6, 4, 6>(frames, input, output);
-	else if(inputChannels == 4 && outputChannels == 8) applyMixingMatrixInterleaved<mixing_matrix_4_8, 4, 8>(frames, input, output);
-	else if(inputChannels == 6 && outputChannels == 1) applyMixingMatrixInterleaved<mixing_matrix_6_1, 6, 1>(frames, input, output);
-	else if(inputChannels == 6 && outputChannels == 2) applyMixingMatrixInterleaved<mixing_matrix_6_2, 6, 2>(frames, input, output);
-	else if(inputChannels == 6 && outputChannels == 4) applyMixingMatrixInterleaved<mixing_matrix_6_4, 6, 4>(frames, input, output);
-	else if(inputChannels == 6 && outputChannels == 8) applyMixingMatrixInterleaved<mixing_matrix_6_8, 6, 8>(frames, input, output);
-	else if(inputChannels == 8 && outputChannels == 1) applyMixingMatrixInterleaved<mixing_matrix_8_1, 8, 1>(frames, input, output);
-	else if(inputChannels == 8 && outputChannels == 2) applyMixingMatrixInterleaved<mixing_matrix_8_2,  8, 2>(frames, input, output);
-	else if(inputChannels == 8 && outputChannels == 4) applyMixingMatrixInterleaved<mixing_matrix_8_4, 8, 4>(frames, input, output);
-	else if(inputChannels == 8 && outputChannels == 6) applyMixingMatrixInterleaved<mixing_matrix_8_6, 8, 6>(frames, input, output);
+	if(inputChannels == 1) upmixMonoInterleaved(frames, input, outputChannels, output);
 	else mixUnrecognizedInterleaved(frames, inputChannels, input, outputChannels, output);
 }
 
 void remixAudioUninterleaved(int frames, int inputChannels, float** inputs, int outputChannels, float** outputs, bool zeroFirst) {
+	if(inputChannels <= MAX_COMPILED_CHANNELS && outputChannels <= MAX_COMPILED_CHANNELS) {
+		applyMixingMatrixUninterleaved(getCompiledMixingMatrix(inputChannels, outputChannels), frames, inputs, outputs, zeroFirst);
+		return;
+	}
 	if(zeroFirst) for(int i = 0; i < outputChannels; i++) std::fill(outputs[i], outputs[i]+frames, 0.0f);
-	if(inputChannels == 1 && outputChannels == 2) applyMixingMatrixUninterleaved<mixing_matrix_1_2, 1, 2>(frames, inputs, outputs);
-	else if(inputChannels == 1 && outputChannels == 4) applyMixingMatrixUninterleaved<mixing_matrix_1_4, 1, 4>(frames, inputs, outputs);
-	else if(inputChannels == 1 && outputChannels == 6) applyMixingMatrixUninterleaved<mixing_matrix_1_6, 1, 6>(frames, inputs, outputs);
-	else if(inputChannels == 1 && outputChannels == 8) applyMixingMatrixUninterleaved<mixing_matrix_1_8, 1, 8>(frames, inputs, outputs);
-	else if(inputChannels == 1) upmixMonoUninterleaved(frames, inputs[0], outputChannels, outputs);
-	else if(inputChannels == 2 && outputChannels == 1) applyMixingMatrixUninterleaved<mixing_matrix_2_1, 2, 1>(frames, inputs, outputs);
-	else if(inputChannels == 2 && outputChannels == 4) applyMixingMatrixUninterleaved<mixing_matrix_2_4, 2, 4>(frames, inputs, outputs);
-	else if(inputChannels == 2 && outputChannels == 6) applyMixingMatrixUninterleaved<mixing_matrix_2_6, 2, 6>(frames, inputs, outputs);
-	else if(inputChannels == 2 && outputChannels == 8) applyMixingMatrixUninterleaved<mixing_matrix_2_8, 2, 8>(frames, inputs, outputs);
-	else if(inputChannels == 4 && outputChannels == 1) applyMixingMatrixUninterleaved<mixing_matrix_4_1, 4, 1>(frames, inputs, outputs);
-	else if(inputChannels == 4 && outputChannels == 2) applyMixingMatrixUninterleaved<mixing_matrix_4_2, 4, 2>(frames, inputs, outputs);
-	else if(inputChannels == 4 && outputChannels == 6) applyMixingMatrixUninterleaved<mixing_matrix_4_6, 4, 6>(frames, inputs, outputs);
-	else if(inputChannels == 4 && outputChannels == 8) applyMixingMatrixUninterleaved<mixing_matrix_4_8, 4, 8>(frames, inputs, outputs);
-	else if(inputChannels == 6 && outputChannels == 1) applyMixingMatrixUninterleaved<mixing_matrix_6_1, 6, 1>(frames, inputs, outputs);
-	else if(inputChannels == 6 && outputChannels == 2) applyMixingMatrixUninterleaved<mixing_matrix_6_2, 6, 2>(frames, inputs, outputs);
-	else if(inputChannels == 6 && outputChannels == 4) applyMixingMatrixUninterleaved<mixing_matrix_6_4, 6, 4>(frames, inputs, outputs);
-	else if(inputChannels == 6 && outputChannels == 8) applyMixingMatrixUninterleaved<mixing_matrix_6_8, 6, 8>(frames, inputs, outputs);
-	else if(inputChannels == 8 && outputChannels == 1) applyMixingMatrixUninterleaved<mixing_matrix_8_1, 8, 1>(frames, inputs, outputs);
-	else if(inputChannels == 8 && outputChannels == 2) applyMixingMatrixUninterleaved<mixing_matrix_8_2,  8, 2>(frames, inputs, outputs);
-	else if(inputChannels == 8 && outputChannels == 4) applyMixingMatrixUninterleaved<mixing_matrix_8_4, 8, 4>(frames, inputs, outputs);
-	else if(inputChannels == 8 && outputChannels == 6) applyMixingMatrixUninterleaved<mixing_matrix_8_6, 8, 6>(frames, inputs, outputs);
+	if(inputChannels == 1) upmixMonoUninterleaved(frames, inputs[0], outputChannels, outputs);
 	else mixUnrecognizedUninterleaved(frames, inputChannels, inputs, outputChannels, outputs);
 }
 
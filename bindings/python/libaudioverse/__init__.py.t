@@ -298,6 +298,28 @@ For full details of this class, see the Libaudioverse manual."""
     def threads(self, value):
         _lav.server_set_threads(self, value)
 
+    @property
+    def minimum_phase_hrtf_length(self):
+        r"""The length of minimum phase filters HRTFs loaded afterwords are converted to, or 0 to use them as they are.
+        
+        This wraps Lav_serverGetMinimumPhaseHrtfLength and Lav_serverSetMinimumPhaseHrtfLength."""
+        return _lav.server_get_minimum_phase_hrtf_length(self)
+        
+    @minimum_phase_hrtf_length.setter
+    def minimum_phase_hrtf_length(self, value):
+        _lav.server_set_minimum_phase_hrtf_length(self, value)
+
+    @property
+    def hrtf_grid(self):
+        r"""A tuple of (azimuth step, elevation step) in degrees for the grid HRTFs loaded afterwords are precomputed on, or (0, 0) for no grid.
+        
+        This wraps Lav_serverGetHrtfGrid and Lav_serverSetHrtfGrid."""
+        return _lav.server_get_hrtf_grid(self)
+        
+    @hrtf_grid.setter
+    def hrtf_grid(self, value):
+        _lav.server_set_hrtf_grid(self, value[0], value[1])
+
 _types_to_classes[ObjectTypes.server] = Server
 
 #Buffer objects.
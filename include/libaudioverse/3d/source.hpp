@@ -8,7 +8,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include "../private/node.hpp"
 #include "../implementations/amplitude_panner.hpp"
 #include "../implementations/hrtf_panner.hpp"
-#include "../implementations/biquad.hpp"
+#include "../implementations/block_biquad.hpp"
 #include <memory>
 #include <set>
 #include <vector>
@@ -38,7 +38,7 @@ class SourceNode: public Node {
 	int panning_strategy;
 	HrtfPanner hrtf_panner;
 	AmplitudePanner stereo_panner, surround40_panner, surround51_panner, surround71_panner;
-	BiquadFilter occlusion_filter;
+	BlockBiquadFilter occlusion_filter;
 	std::shared_ptr<EnvironmentNode> environment;
 	std::shared_ptr<HrtfData> hrtf_data;
 	std::map<int, AmplitudePanner*> fed_effects;
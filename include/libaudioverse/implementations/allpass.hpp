@@ -5,6 +5,9 @@ You may use this code under the terms of either license at your option.
 A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #pragma once
+#include "delayline.hpp"
+#include "../private/kernels.hpp"
+#include <algorithm>
 
 namespace libaudioverse_implementation {
 
@@ -22,6 +25,8 @@ class AllpassFilter {
 	AllpassFilter(args... delay_args): line(delay_args...) {}
 	void setCoefficient(float c);
 	float tick(float input);
+	//Block processing, for lines with readBlock and writeBlock.  in-place is okay.
+	void process(int length, float* input, float* output);
 	//These are for nesting.  Call the first one, feed it through the nested filter, call the second one.
 	//This returns the internal line value.
 	float beginNestedTick();
@@ -47,6 +52,20 @@ float AllpassFilter<delay_type>::tick(float input) {
 	return endNestedTick(input, beginNestedTick());
 }
 
+template<typename delay_type>
+void AllpassFilter<delay_type>::process(int length, float* input, float* output) {
+	float lineValues[DELAY_LINE_BLOCK_LENGTH], recursion[DELAY_LINE_BLOCK_LENGTH];
+	int done = 0;
+	while(done < length) {
+		int count = line.readBlock(std::min(length-done, DELAY_LINE_BLOCK_LENGTH), lineValues);
+		//endNestedTick, a block at a time.
+		multiplicationAdditionKernel(count, -coefficient, lineValues, input+done, recursion);
+		multiplicationAdditionKernel(count, coefficient, recursion, lineValues, output+done);
+		line.writeBlock(count, recursion);
+		done += count;
+	}
+}
+
 template<typename delay_type>
 float AllpassFilter<delay_type>::beginNestedTick() {
 	return line.computeSample();
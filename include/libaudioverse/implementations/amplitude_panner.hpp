@@ -23,6 +23,8 @@ class AmplitudePanner {
 	AmplitudePanner(int _block_size, float _sr);
 	void clearMap();
 	void addEntry(float angle, int channel);
+	//Ramps the gains across the block when the azimuth changes.
+	//Channels that are silent for the whole block aren't written, so the caller must zero the outputs first.
 	void pan(float* input, float** outputs);
 	void readMap(int entries, float* map);
 	float getAzimuth();
@@ -30,7 +32,14 @@ class AmplitudePanner {
 	float getElevation();
 	void setElevation(float e);
 	private:
+	//Fills target_gains for the current azimuth, one per entry of channels.
+	void computeGains();
 	std::vector<AmplitudePannerEntry> channels;
+	//The gains at the end of the last block and the gains for the azimuth they were computed at, indexed like channels.
+	std::vector<float> gains, target_gains;
+	float gains_azimuth = 0.0f;
+	//Set when the map changes, so that the next block recomputes and jumps straight to the new gains.
+	bool map_changed = true;
 	float azimuth = 0.0f, elevation = 0.0f;
 	float sr;
 	int block_size;
@@ -8,6 +8,9 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 
 namespace libaudioverse_implementation {
 
+//When modulated, filters are redesigned this often and interpolate their coefficients in between.
+const int BIQUAD_MODULATION_INTERVAL = 32;
+
 /**Header-only biquad, and design function.
 This class needs to be as fast as possible, and we want inlining whenever possible.
 */
@@ -26,6 +29,11 @@ class BiquadFilter {
 
 	BiquadFilter* getSlave();
 	void setSlave(BiquadFilter* s);	
+	//Tick up to 4 filters at once, one per channel.  Used by MultichannelFilterBank.
+	static void processLanes(int count, BiquadFilter** filters, int length, float** inputs, float** outputs);
+	//Like processLanes, but moves the coefficients linearly from those of the first filter to target (b0, b1, b2, a1, a2), which all the filters have afterwords.
+	//Stable biquads form a convex set, so this stays stable if both ends are.
+	static void processLanesRamped(int count, BiquadFilter** filters, int length, float** inputs, float** outputs, const double* target);
 	
 	double b0 = 1.0, b1 = 0.0, b2 = 0.0;
 	double a1 = 0.0, a2 = 0.0;
@@ -39,6 +47,9 @@ class BiquadFilter {
 
 //separate so it can be used by both this and the IIR filter.
 void biquadConfigurationImplementation(double sr, int type, double frequency, double dbGain, double q, double &b0, double &b1, double &b2, double &a0, double &a1, double &a2);
+//For modulation: writes the normalized b0, b1, b2, a1, a2 to coefficients.
+//The parameters are rounded to about 1 part in 16000, and recent designs are cached per thread so that filters sweeping together share the work.
+void biquadDesignCached(double sr, int type, double frequency, double dbGain, double q, double* coefficients);
 
 inline float BiquadFilter::tick(float input)  {
 	//Direct form 2: apply the  recursive  filter first.
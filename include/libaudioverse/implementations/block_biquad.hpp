@@ -0,0 +1,46 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#pragma once
+
+namespace libaudioverse_implementation {
+
+/**A biquad which computes 4 samples at once, for mono signals where there are no channels to spread across SIMD lanes.
+
+The filter runs in transposed direct form 2, whose 2 state variables stay on the order of the output and are therefore safe in single precision.
+Over 4 samples, the outputs and the next state are linear in the current state and the 4 inputs.
+We precompute those matrices whenever the coefficients change, so that a block of 4 is a handful of vector multiply-adds.
+Coefficient changes take effect at the next call to process.
+
+Output matches BiquadFilter to within the error of rounding the coefficients to single precision, which is below -60 DB relative to the output even for poles near 1; see src/utils/block_biquad_error.cpp.*/
+class BlockBiquadFilter {
+	public:
+	BlockBiquadFilter(float _sr);
+	void configure(int type, double frequency, double dbGain, double q);
+	void setCoefficients(double b0, double b1, double b2, double a1, double a2);
+	void process(int length, float* input, float* output);
+	float tick(float input);
+	void reset();
+	private:
+	float sr;
+	double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+	//Single precision copies for tick.
+	float fb0 = 1.0f, fb1 = 0.0f, fb2 = 0.0f, fa1 = 0.0f, fa2 = 0.0f;
+	//Row k is the contribution of state variable or input sample k to the 4 outputs or the next state.
+	//The state rows only use their first 2 entries.
+	float state_to_output[2][4], input_to_output[4][4];
+	float state_to_state[2][4], input_to_state[4][4];
+	float s1 = 0.0f, s2 = 0.0f;
+};
+
+inline float BlockBiquadFilter::tick(float input) {
+	float output = fb0*input+s1;
+	s1 = fb1*input-fa1*output+s2;
+	s2 = fb2*input-fa2*output;
+	return output;
+}
+
+}
\ No newline at end of file
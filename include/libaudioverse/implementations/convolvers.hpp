@@ -5,10 +5,13 @@ You may use this code under the terms of either license at your option.
 A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #pragma once
-#include <kiss_fftr.h>
+#include <vector>
+#include <memory>
 
 namespace libaudioverse_implementation {
 
+class FftPlan;
+
 class BlockConvolver {
 	public:
 	BlockConvolver(int blockSize);
@@ -20,32 +23,188 @@ class BlockConvolver {
 	void convolve(float* input, float* output);
 	void reset();
 	private:
+	//A ring of capacity samples, stored twice over so that the window convolve needs is always contiguous.
 	float* response = nullptr, *history = nullptr;
-	int block_size = 0, response_length = 0;
+	int block_size = 0, response_length = 0, capacity = 0, position = 0;
 };
 
+/**Convolves with a list of taps, each of which costs a scaled add of one block from a delay ring.
+For early reflections and multitap echoes, which are mostly zeros, this is far cheaper than treating the response as dense.*/
+class SparseConvolver {
+	public:
+	SparseConvolver(int blockSize);
+	~SparseConvolver();
+	//Keeps the taps whose magnitude is above threshold.
+	void setResponse(int length, float* response, float threshold = 0.0f);
+	//Delays are in samples and may repeat; errors if any is negative.
+	void setTaps(int count, int* delays, float* gains);
+	void convolve(float* input, float* output);
+	void reset();
+	int getTapCount();
+	private:
+	void resizeRing(int maxDelay);
+	//Sorted by delay, so that convolve walks the ring in one direction.
+	std::vector<int> delays;
+	std::vector<float> gains;
+	//Written twice over, like BlockConvolver's.
+	float* history = nullptr;
+	int block_size = 0, capacity = 0, position = 0;
+};
+
+//How many samples of response have a magnitude above threshold.
+int countSparseTaps(int length, float* response, float threshold = 0.0f);
+
 class FftConvolver {
 	public:
 	FftConvolver(int blockSize);
 	~FftConvolver();
 	void setResponse(int length, float* response);
 	void convolve(float* input, float* output);
-	//Convolve with an fft of the input.
-	//This fft must meet a size requirement, queerieable by getFftSize().
-	//Must be computed with kiss_fftr.
-	void convolveFft(kiss_fft_cpx *fft, float* output);
-	//If using convolveFft, this is the size to which the input must be zero-padded.
-	int getFftSize();
-	//Returns an fft of the input that can be used with fftConvolve.
-	//This fft will be valid until either getFft or convolve is called.
-	//This exists for a very very few special cases in Libaudioverse.
-	kiss_fft_cpx* getFft(float* input);
 	void reset();
 	private:
-	int block_size = 0, fft_size = 0, tail_size= 0, workspace_size = 0;
-	float*workspace = nullptr, *tail = nullptr;
-	kiss_fft_cpx *response_fft = nullptr, *block_fft = nullptr;
-	kiss_fftr_cfg fft = nullptr, ifft = nullptr;
+	void freeArrays();
+	int block_size = 0, fft_size = 0, bins = 0, tail_size = 0;
+	float* workspace = nullptr, *tail = nullptr;
+	float* response_real = nullptr, *response_imag = nullptr, *block_real = nullptr, *block_imag = nullptr;
+	std::shared_ptr<FftPlan> plan;
+};
+
+/**The spectra of a response split into partitions of one block, as PartitionedConvolver uses them.
+These never change once built, so all convolvers with the same block size and response share one; get them from getPartitionedResponse.*/
+class PartitionedResponse {
+	public:
+	PartitionedResponse(int blockSize, int length, float* response);
+	//A silent response of length samples, for mix to fill.
+	PartitionedResponse(int blockSize, int length);
+	~PartitionedResponse();
+	bool matches(int blockSize, int length, float* response);
+	//Sets the spectra to the weighted sum of the sources', which must have the same block size and partition count.
+	//This is the spectra of the weighted sum of their responses, without any ffts.
+	//Only for responses nobody shares: it's the one exception to never changing, and no samples are kept, so it won't match anything afterwords.
+	void mix(int count, PartitionedResponse** sources, const float* weights);
+	int getBlockSize();
+	int getPartitionCount();
+	//Partition p's spectrum starts at p*stride, prescaled for the inverse fft.
+	const float* getReal();
+	const float* getImag();
+	private:
+	int block_size = 0, partition_count = 0;
+	std::vector<float> samples;
+	float* real = nullptr, *imag = nullptr;
+};
+
+//Thread safe.  Responses stay cached only while something uses them.
+std::shared_ptr<PartitionedResponse> getPartitionedResponse(int blockSize, int length, float* response);
+void initializePartitionedResponseCache();
+void shutdownPartitionedResponseCache();
+
+/**Uniformly partitioned overlap-save convolution, for long responses.
+The response is split into partitions of one block, and the ffts of the last partition-count input blocks are kept in a ring.
+Each block then costs one fft and inverse fft of at least twice the block size, plus a complex multiply-add per partition.
+There is no added latency.
+
+A convolver can hold several responses for the same input, such as the channels of a reverb fed by one source.
+The input is transformed once for all of them, so each extra response costs only its multiply-adds and an inverse fft.
+
+The history is only input, so changing a response keeps it: the new response applies to everything already heard, and the ring is resized in place.*/
+class PartitionedConvolver {
+	public:
+	PartitionedConvolver(int blockSize, int responseCount = 1);
+	~PartitionedConvolver();
+	void setResponse(int length, float* response);
+	void setResponse(int index, int length, float* response);
+	//If crossfade is true, the next block fades from the old response to this one.
+	//The old response is kept until the next change, so that the audio thread never frees it.
+	//If displaced isn't null, the responses this stops using are appended to it, so that the caller can free them after unlocking.
+	void setResponse(int index, std::shared_ptr<PartitionedResponse> response, bool crossfade = false, std::vector<std::shared_ptr<PartitionedResponse>>* displaced = nullptr);
+	void convolve(float* input, float* output);
+	//outputs has one buffer per response.
+	void convolve(float* input, float** outputs);
+	void reset();
+	int getPartitionCount();
+	int getResponseCount();
+	private:
+	void freeArrays();
+	//Keeps the newest count input spectra.
+	void resizeRing(int count);
+	void convolveResponse(PartitionedResponse* response, float* output);
+	int block_size = 0, fft_size = 0, bins = 0, stride = 0, partition_count = 0;
+	//Index of the newest input spectrum in the ring.
+	int current = 0;
+	//The last fft_size samples of input, a place for the inverse fft, and the old response's output while crossfading.
+	float* input_history = nullptr, *workspace = nullptr, *crossfade_workspace = nullptr;
+	//Spectra are split into real and imaginary parts, stride apart so that every partition is aligned.
+	float* line_real = nullptr, *line_imag = nullptr;
+	float* accumulator_real = nullptr, *accumulator_imag = nullptr;
+	std::vector<std::shared_ptr<PartitionedResponse>> responses, previous_responses;
+	std::vector<bool> crossfading;
+	std::shared_ptr<FftPlan> plan;
+};
+
+enum class ConvolutionEngine {
+	DIRECT, //BlockConvolver.
+	FFT, //FftConvolver.
+	PARTITIONED, //PartitionedConvolver.
+	SPARSE, //SparseConvolver.
+};
+
+//Picks the engine the cost model expects to be cheapest for this block size and response length.
+//tapCount is the number of nonzero samples, or -1 to rule out SparseConvolver.
+//The model's constants are measured on this machine by calibrateConvolutionCosts, which Lav_initialize calls.
+ConvolutionEngine chooseConvolutionEngine(int blockSize, int responseLength, int tapCount = -1);
+//Takes tens of milliseconds, so it mustn't happen while a server is locked.  Thread safe, and only measures once.
+void calibrateConvolutionCosts();
+
+/**Convolves with whichever engine is cheapest for the block size and response length.
+Changing to a response that needs a different engine clears the history.*/
+class AutomaticConvolver {
+	public:
+	AutomaticConvolver(int blockSize);
+	~AutomaticConvolver();
+	void setResponse(int length, float* response);
+	//Always uses SparseConvolver, since nothing else takes taps.
+	void setTaps(int count, int* delays, float* gains);
+	void convolve(float* input, float* output);
+	void reset();
+	ConvolutionEngine getEngine();
+	private:
+	//Creates the engine's convolver and deletes the others, unless it's already the one in use.
+	void useEngine(ConvolutionEngine newEngine);
+	int block_size = 0;
+	ConvolutionEngine engine = ConvolutionEngine::DIRECT;
+	BlockConvolver* direct = nullptr;
+	FftConvolver* fft = nullptr;
+	PartitionedConvolver* partitioned = nullptr;
+	SparseConvolver* sparse = nullptr;
 };
 
+//The largest partition NonUniformConvolver uses, rounded down to the block size times a power of 2.  Beyond this, bigger ffts stop paying for themselves.
+const int NONUNIFORM_CONVOLVER_MAX_PARTITION = 8192;
+
+class NonUniformConvolverStage;
+
+/**Non-uniformly partitioned convolution with no latency, for very long responses at small block sizes.
+The first block of the response is convolved directly.
+The rest is split into stages whose partitions double in size up to NONUNIFORM_CONVOLVER_MAX_PARTITION, each starting at twice its partition size.
+Stages with partitions bigger than a block run on the convolution threads, and have one partition's worth of blocks to finish.*/
+class NonUniformConvolver {
+	public:
+	NonUniformConvolver(int blockSize);
+	~NonUniformConvolver();
+	//Always zeros the history.
+	void setResponse(int length, float* response);
+	void convolve(float* input, float* output);
+	//Waits for any background work first.
+	void reset();
+	private:
+	void clearStages();
+	int block_size = 0;
+	BlockConvolver head;
+	std::vector<NonUniformConvolverStage*> stages;
+};
+
+//The threads on which NonUniformConvolver does its big partitions.  Called from Lav_initialize and Lav_shutdown.
+void initializeConvolutionThreads();
+void shutdownConvolutionThreads();
+
 }
\ No newline at end of file
@@ -5,9 +5,13 @@ You may use this code under the terms of either license at your option.
 A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #pragma once
+#include <algorithm>
 
 namespace libaudioverse_implementation {
 
+//The most samples a delay line reads in one call to readBlock, so that scratch space can live on the stack.
+const int DELAY_LINE_BLOCK_LENGTH = 128;
+
 //used by all delay lines.
 //This is a fixed-sized ringbuffer that can be advanced and written to as a single operation or read at a single offset.
 //The length is made to be a power of two when constructed, enabling use of bit tricks for performance.
@@ -17,8 +21,16 @@ class DelayRingbuffer {
 	DelayRingbuffer(const DelayRingbuffer& other) = delete;
 	~DelayRingbuffer();
 	float read(unsigned int offset);
+	//Fills output with read(offset), read(offset-1), ..., which is what read(offset) would return between each of the next length advances.
+	//Length must be at most offset+1, so that none of the samples are ones those advances would write.
+	void readBlock(unsigned int offset, int length, float* output);
+	//Like readBlock, but linearly interpolated between samples, with the offset changing by velocity after every sample.
+	//Length must be at most 1 more than the smallest offset used.
+	void readInterpolatedBlock(double offset, double velocity, int length, float* output);
 	unsigned int getLength();
 	void advance(float sample);
+	//Equivalent to calling advance on every sample of input.
+	void writeBlock(int length, float* input);
 	void write(unsigned int offset, float value);
 	void add(unsigned int index, float value);
 	void reset();
@@ -37,9 +49,13 @@ class CrossfadingDelayLine {
 	void setDelayInSamples(int newDelay);
 	//convenience function: combination compute and advance.
 	float tick(float sample);
-	//feedback has to use the slow path, but this one is optimized.
-	//in-place is okay.
+	//For use without feedback.  in-place is okay.
 	void processBuffer(int length, float* input, float* output);
+	//Block versions of computeSample and advance, for feedback.
+	//readBlock reads at most length samples and returns how many it read, which may be fewer.
+	//The caller must then call writeBlock with exactly that many samples before reading again.
+	int readBlock(int length, float* output);
+	void writeBlock(int length, float* input);
 	float computeSample();
 	void advance(float sample);
 	void write(float delay, float value);
@@ -66,12 +82,18 @@ class DoppleringDelayLine {
 	void setDelayInSamples(int newDelay);
 	void setInterpolationTime(float t);
 	float tick(float sample);
+	//These work as they do on CrossfadingDelayLine.
+	void processBuffer(int length, float* input, float* output);
+	int readBlock(int length, float* output);
+	void writeBlock(int length, float* input);
 	float computeSample();
 	void advance(float sample);
 	void reset();
 	DoppleringDelayLine* getSlave();
 	void setSlave(DoppleringDelayLine* s);
 	private:
+	//Moves the delay length samples further through a change.
+	void advanceDelay(int length);
 	int max_delay = 0, interpolating_direction = 0;
 	double delay = 0.0, new_delay = 0.0;
 	int counter = 0; //counts down delay changes
@@ -88,6 +110,10 @@ class InterpolatedDelayLine {
 	void setDelay(float d);
 	void setDelayInSamples(int samples);
 	float tick(float sample);
+	//These work as they do on CrossfadingDelayLine.
+	void processBuffer(int length, float* input, float* output);
+	int readBlock(int length, float* output);
+	void writeBlock(int length, float* input);
 	float computeSample();
 	void advance(float sample);
 	void reset();
@@ -101,4 +127,24 @@ class InterpolatedDelayLine {
 	InterpolatedDelayLine* slave = nullptr;
 };
 
+//Implements processBuffer for delay lines in terms of their readBlock and writeBlock.
+template<typename line_type>
+void processDelayLineBuffer(line_type &line, int length, float* input, float* output) {
+	float saved[DELAY_LINE_BLOCK_LENGTH];
+	int done = 0;
+	while(done < length) {
+		int remaining = length-done;
+		float* in = input+done;
+		//Reading first would overwrite the input before it's written.
+		if(input == output) {
+			remaining = std::min(remaining, DELAY_LINE_BLOCK_LENGTH);
+			std::copy(in, in+remaining, saved);
+			in = saved;
+		}
+		int count = line.readBlock(remaining, output+done);
+		line.writeBlock(count, in);
+		done += count;
+	}
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#pragma once
+#include <random>
+
+namespace libaudioverse_implementation {
+
+/**The 8 delay lines of FdnReverbNode, with their householder feedback, lowpass filters, and random delay modulation.
+
+All per-line state is stored as arrays of 8, one entry per line, and the lines share one buffer of interleaved 8-sample frames.
+Each sample of the reverb is then a handful of operations on two 4-wide SIMD registers, plus 16 scalar loads for the interpolated reads, which are at different positions in every line.
+Writes are a single frame.
+
+The modulators are the same as InterpolatedRandomGenerator: normally distributed targets with standard deviation 0.5, clipped to -1 to 1, and linearly interpolated between.*/
+class FdnReverbCore {
+	public:
+	//seeds are for the 8 modulators.
+	FdnReverbCore(float sr, float maxDelay, const int* seeds);
+	~FdnReverbCore();
+	//In seconds, before modulation.
+	void setDelays(const float* delays);
+	void setFeedbackGains(const float* gains);
+	void setCutoff(float frequency);
+	//Depth is in seconds.  A depth or frequency of 0 turns modulation off.
+	void setModulation(float depth, float frequency);
+	//Input i feeds lines i and i+4.  Output i is line i+4.
+	void process(int length, float** inputs, float** outputs);
+	private:
+	//Starts the next segment of any modulator which has reached its target.
+	void nextTargets();
+	float drawTarget(int line);
+	float sr;
+	float* buffer = nullptr;
+	unsigned int frame_count = 0, mask = 0, write_head = 0;
+	//These are all 8 long.  Delays are in samples.
+	float *base_delays = nullptr, *delays = nullptr, *feedback_gains = nullptr, *filter_history = nullptr;
+	float *modulator_from = nullptr, *modulator_to = nullptr, *modulator_weight = nullptr;
+	//The lowpass is the same for every line.
+	float b0 = 1.0f, a1 = 0.0f;
+	bool modulating = false;
+	float modulation_depth = 0.0f, modulation_delta = 0.0f;
+	std::minstd_rand engines[8];
+	std::normal_distribution<float> distributions[8];
+};
+
+}
\ No newline at end of file
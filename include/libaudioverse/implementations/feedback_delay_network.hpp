@@ -7,6 +7,9 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #pragma once
 #include "delayline.hpp"
 #include "../private/kernels.hpp"
+#include "../private/dspmath.hpp"
+#include "../private/memory.hpp"
+#include <algorithm>
 
 namespace libaudioverse_implementation {
 /**A feedback delay network consists of the following:
@@ -22,6 +25,9 @@ This matches the formulation given in Physical Audio Processing for Virtual Musi
 We use a template here because it is necessary to change the type of the delay line.
 Since the advance/read functions would be called n times per sample, virtual functions are unacceptible.
 This has the side effect of moving everything into the header.
+
+setMatrix recognizes hadamard and householder matrices with gains applied to their rows or columns.
+These are applied with a fast Walsh-Hadamard transform or a single sum, rather than a dot product per line, which is what makes large networks affordable.
 */
 template <class LineType=CrossfadingDelayLine>
 class FeedbackDelayNetwork {
@@ -32,12 +38,18 @@ class FeedbackDelayNetwork {
 		lines = new LineType*[n];
 		for(int i = 0; i < n; i++) lines[i] = new LineType(maxDelay, sr);
 		matrix = allocArray<float>(n*n);
+		row_gains = allocArray<float>(n);
+		column_gains = allocArray<float>(n);
+		mixed = allocArray<float>(n);
 	}
 	
 	~FeedbackDelayNetwork() {
 	for(int i = 0; i < n; i++) delete lines[i];
 		delete[] lines;
 		freeArray(matrix);
+		freeArray(row_gains);
+		freeArray(column_gains);
+		freeArray(mixed);
 	}
 	
 	void computeFrame(float* outputs) {
@@ -47,15 +59,31 @@ class FeedbackDelayNetwork {
 	}
 	
 	void advance(const float* inputs, const float* lastOutputFrame) {
-		for(int i=0; i < n; i++) {
-			float sample=dotKernel(n, matrix+n*i, lastOutputFrame);
-			sample+=inputs[i];
-			lines[i]->advance(sample);
+		if(matrix_structure == MatrixStructure::GENERAL) {
+			for(int i=0; i < n; i++) {
+				float sample=dotKernel(n, matrix+n*i, lastOutputFrame);
+				sample+=inputs[i];
+				lines[i]->advance(sample);
+			}
+			return;
+		}
+		for(int i = 0; i < n; i++) mixed[i] = column_gains[i]*lastOutputFrame[i];
+		if(matrix_structure == MatrixStructure::HADAMARD) fastWalshHadamard(n, mixed);
+		else {
+			//I-(2/n)*ones subtracts 2/n of the sum from every entry.
+			float sum = 0.0f;
+			for(int i = 0; i < n; i++) sum += mixed[i];
+			float reflection = 2.0f*sum/n;
+			for(int i = 0; i < n; i++) mixed[i] -= reflection;
 		}
+		for(int i = 0; i < n; i++) lines[i]->advance(row_gains[i]*mixed[i]+inputs[i]);
 	}
 	
 	void setMatrix(const float* feedbacks) {
 		std::copy(feedbacks, feedbacks+n*n, matrix);
+		if(factorScaledHadamard(n, matrix, row_gains, column_gains)) matrix_structure = MatrixStructure::HADAMARD;
+		else if(factorScaledHouseholder(n, matrix, row_gains, column_gains)) matrix_structure = MatrixStructure::HOUSEHOLDER;
+		else matrix_structure = MatrixStructure::GENERAL;
 	}
 	
 	void setDelays(const float* delays) {
@@ -75,10 +103,14 @@ class FeedbackDelayNetwork {
 	}
 	
 	private:
+	enum class MatrixStructure {GENERAL, HADAMARD, HOUSEHOLDER};
 	int n;
 	float sr;
 	LineType **lines = nullptr;
 	float *matrix = nullptr;
+	//For structured matrices, the matrix is diag(row_gains)*structure*diag(column_gains).
+	MatrixStructure matrix_structure = MatrixStructure::GENERAL;
+	float *row_gains = nullptr, *column_gains = nullptr, *mixed = nullptr;
 };
 
 }
\ No newline at end of file
@@ -9,6 +9,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <algorithm>
 #include <stdio.h>
 #include "../private/constants.hpp"
+#include "../private/kernels.hpp"
 
 namespace libaudioverse_implementation {
 
@@ -34,6 +35,8 @@ class FirstOrderFilter {
 	void reset();	
 	FirstOrderFilter* getSlave();
 	void setSlave(FirstOrderFilter* s);
+	//Tick up to 4 filters at once, one per channel.  Used by MultichannelFilterBank.
+	static void processLanes(int count, FirstOrderFilter** filters, int length, float** inputs, float** outputs);
 	
 	float b0 = 1.0, b1 = 0.0, a1 = 0.0;
 	private:
@@ -57,7 +60,7 @@ inline void FirstOrderFilter::setPolePosition(float pos, bool shouldNormalize) {
 	if(slave) slave->setPolePosition(pos, shouldNormalize);
 }
 
-float FirstOrderFilter::getPolePosition() {
+inline float FirstOrderFilter::getPolePosition() {
 	return -a1;
 }
 
@@ -132,6 +135,22 @@ inline void FirstOrderFilter::reset() {
 	if(slave) slave->reset();
 }
 
+inline void FirstOrderFilter::processLanes(int count, FirstOrderFilter** filters, int length, float** inputs, float** outputs) {
+	float coefficients[12], history[8];
+	for(int i = 0; i < count; i++) {
+		coefficients[i] = filters[i]->b0;
+		coefficients[4+i] = filters[i]->b1;
+		coefficients[8+i] = filters[i]->a1;
+		history[i] = filters[i]->lastInput;
+		history[4+i] = filters[i]->lastOutput;
+	}
+	firstOrderLanesKernel(count, length, inputs, outputs, coefficients, history);
+	for(int i = 0; i < count; i++) {
+		filters[i]->lastInput = history[i];
+		filters[i]->lastOutput = history[4+i];
+	}
+}
+
 inline FirstOrderFilter* FirstOrderFilter::getSlave() {
 	return slave;
 }
@@ -13,6 +13,9 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 namespace libaudioverse_implementation {
 
 //Implement HRTF panning.
+//In the frequency domain, the source block is transformed once, the spectra for the direction are mixed from ones precomputed for every hrir, and each ear is one inverse fft.
+//Otherwise, each ear is a direct convolution.  The constructor picks whichever is cheaper for the block size and hrir length.
+//If the hrtf is minimum phase, the interaural delay is applied after convolution with a delay line per ear.
 
 class HrtfPanner {
 	public:
@@ -30,10 +33,22 @@ class HrtfPanner {
 	//Also known as manhattan distance.
 	void setCrossfadeThreshold(float threshold);
 	float getCrossfadeThreshold();
+	//Switching clears the history.
+	void setFrequencyDomain(bool fd);
+	bool getFrequencyDomain();
 	private:
+	void setDelays();
 	std::shared_ptr<HrtfData> hrtf;
 	//Convolvers, current and previous.
 	BlockConvolver *left_convolver, *right_convolver, *prev_left_convolver, *prev_right_convolver;
+	//Left is response 0 and right response 1, so both share the input's fft.
+	PartitionedConvolver *frequency_convolver = nullptr;
+	std::shared_ptr<HrirSpectra> spectra;
+	//Per ear, the current response, the one the convolver may be fading from, and a free one to mix the next direction into.
+	//Reusing these means moving never allocates.
+	std::shared_ptr<PartitionedResponse> left_spectra[3], right_spectra[3];
+	bool frequency_domain = false;
+	DoppleringDelayLine *left_delay_line = nullptr, *right_delay_line = nullptr;
 	int block_size;
 	int response_length;
 	float sr;
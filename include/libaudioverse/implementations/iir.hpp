@@ -5,21 +5,33 @@ You may use this code under the terms of either license at your option.
 A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #pragma once
+#include <vector>
 
 namespace libaudioverse_implementation {
 
+/**A filter with arbitrary numerator and denominator.
+
+configure factors the transfer function into cascaded second-order sections when it can, which is faster and much better behaved numerically for high orders.
+If factoring fails, we fall back to running the direct form as given.*/
 class IIRFilter {
 	public:
 	IIRFilter(double sr);
+	~IIRFilter();
 	float tick(float sample);
+	void process(int length, float* input, float* output);
 	void configure(int newNumeratorLength, double* newNumerator, int newDenominatorLength,  double* newDenominator);
 	void setGain(double gain);
 	void clearHistories();
 	void configureBiquad(int type, double frequency, double dbGain, double q);
 	double qFromBw(double frequency, double bw);
 	double qFromS(double frequency, double s);
+	bool usesSections();
 	
 	private:
+	//Applies gain to the first section.
+	void rebuildSections();
+	//5 coefficients and 2 history values per section, as biquadCascadeKernel wants.  Empty if using the direct form.
+	std::vector<double> unscaled_sections, sections, section_history;
 	double *history = nullptr, *recursion_history = nullptr, *numerator = nullptr, *denominator = nullptr;
 	int numerator_length = 0, denominator_length = 0;
 	double gain = 1.0;
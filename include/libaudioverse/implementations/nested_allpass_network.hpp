@@ -5,6 +5,10 @@ You may use this code under the terms of either license at your option.
 A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #pragma once
+#include "biquad.hpp"
+#include "one_pole_filter.hpp"
+#include "allpass.hpp"
+#include "delayline.hpp"
 #include <vector>
 
 namespace libaudioverse_implementation {
@@ -35,6 +39,27 @@ class NestedAllpassNetworkASTNode {
 	NestedAllpassNetworkASTNode *nested = nullptr, *next = nullptr;
 	//Used for the reader.
 	float reader_mul = 1.0f;
+	//Used for allpasses, to bound how many samples the compiled program can run at once.
+	int delay = 0;
+};
+
+/**Compile lowers the AST into a flat program of these.
+Nested allpasses become a begin instruction, the nested row, and an end instruction; the value fed to the nested row is saved on a stack in between.
+Identities disappear.*/
+enum class NestedAllpassNetworkOpcodes {
+	ALLPASS, BEGIN_NESTED, END_NESTED, ONE_POLE, BIQUAD, READER,
+};
+
+/**The one-pole and biquad state is copied in from the AST so that running the program walks one contiguous array.
+Allpasses point at the AST's filters, since their lines are too big to copy around.*/
+class NestedAllpassNetworkInstruction {
+	public:
+	NestedAllpassNetworkInstruction(NestedAllpassNetworkOpcodes opcode, float sr);
+	NestedAllpassNetworkOpcodes opcode;
+	AllpassFilter<InterpolatedDelayLine>* allpass = nullptr;
+	OnePoleFilter one_pole;
+	BiquadFilter biquad;
+	float reader_mul = 1.0f;
 };
 
 /**This class builds networks of nested allpasses and lowpasses, most commonly used in Schroeder reverb designs.
@@ -66,6 +91,10 @@ class NestedAllpassNetwork {
 	void compile();
 	//Standard filter stuff.
 	float tick(float input);
+	//Runs the program an instruction at a time over as many samples as the shortest allpass allows.  In-place is okay.
+	void process(int length, float* input, float* output);
+	//Walks the AST instead of running the program.  Kept for benchmarking; don't mix this with tick or process on the same network.
+	float tickInterpreted(float input);
 	void reset();
 	NestedAllpassNetwork* getSlave();
 	void setSlave(NestedAllpassNetwork* s);
@@ -74,6 +103,7 @@ class NestedAllpassNetwork {
 	void contribute(float amount);
 	private:
 	void hookupAST(NestedAllpassNetworkASTNode* node);
+	void emitRow(NestedAllpassNetworkASTNode* row, int depth);
 	float sr, next_output;
 	//Used to push and pop nesting levels, etc.
 	std::vector<NestedAllpassNetworkASTNode*> stack;
@@ -83,6 +113,13 @@ class NestedAllpassNetwork {
 	NestedAllpassNetworkASTNode* current = nullptr, *next_start = nullptr;
 	//The first node in our tree.
 	NestedAllpassNetworkASTNode* start = nullptr;
+	//The compiled form of start.
+	std::vector<NestedAllpassNetworkInstruction> program;
+	//The most samples process can run through the program at once: the shortest allpass delay plus one, capped at DELAY_LINE_BLOCK_LENGTH.
+	int chunk_length = DELAY_LINE_BLOCK_LENGTH;
+	//The deepest nesting in the program, and stacks of that size for the values saved by BEGIN_NESTED.
+	int max_depth = 0;
+	std::vector<float> sample_stack, block_stack;
 	NestedAllpassNetwork* slave = nullptr;
 };
 
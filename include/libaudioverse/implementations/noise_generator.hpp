@@ -0,0 +1,48 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#pragma once
+
+namespace libaudioverse_implementation {
+
+/**Generates blocks of gaussian noise.
+
+The random numbers come from 4 independent xorshift generators, one per SIMD lane, which are turned into gaussian samples 8 at a time with the Box-Muller transform.
+Samples are normally distributed with standard deviation 0.25, and are redrawn if they fall outside -1 to 1.
+The output depends only on the seed and the sequence of lengths requested.*/
+class NoiseGenerator {
+	public:
+	NoiseGenerator(unsigned int seed);
+	~NoiseGenerator();
+	void white(int length, float* output);
+	void setSeed(unsigned int seed);
+	private:
+	//Draws one sample with the scalar path, used to redraw rejected samples.
+	float redraw();
+	unsigned int *state = nullptr;
+	float* workspace = nullptr;
+	int workspace_length = 0;
+};
+
+/**Up to 4 one-pole sections run in parallel, one per SIMD lane, and summed along with a direct term.
+
+This is the partial fraction expansion of a filter with real and distinct poles:
+H(z) = direct+sum(residues[i]/(1-poles[i]*z^-1))
+Which is what we need for coloring noise.*/
+class PartialFractionFilter {
+	public:
+	PartialFractionFilter();
+	~PartialFractionFilter();
+	void configure(int count, const double* poles, const double* residues, double direct);
+	void process(int length, float* input, float* output);
+	void reset();
+	private:
+	//All 4 long, with unused sections zeroed.
+	float *poles = nullptr, *residues = nullptr, *state = nullptr;
+	float direct = 0.0f;
+};
+
+}
\ No newline at end of file
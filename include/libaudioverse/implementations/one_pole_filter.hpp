@@ -7,6 +7,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #pragma once
 #include <math.h>
 #include "../private/constants.hpp"
+#include "../private/kernels.hpp"
 
 namespace libaudioverse_implementation {
 
@@ -23,6 +24,8 @@ class OnePoleFilter {
 
 	OnePoleFilter* getSlave();
 	void setSlave(OnePoleFilter* s);
+	//Tick up to 4 filters at once, one per channel.  Used by MultichannelFilterBank.
+	static void processLanes(int count, OnePoleFilter** filters, int length, float** inputs, float** outputs);
 	float b0 = 1.0, a1 = 0.0;
 	private:
 	double sr = 0.0;
@@ -75,6 +78,17 @@ inline void OnePoleFilter::reset() {
 	if(slave) slave->reset();
 }
 
+inline void OnePoleFilter::processLanes(int count, OnePoleFilter** filters, int length, float** inputs, float** outputs) {
+	float coefficients[8], history[4];
+	for(int i = 0; i < count; i++) {
+		coefficients[i] = filters[i]->b0;
+		coefficients[4+i] = filters[i]->a1;
+		history[i] = filters[i]->last;
+	}
+	onePoleLanesKernel(count, length, inputs, outputs, coefficients, history);
+	for(int i = 0; i < count; i++) filters[i]->last = history[i];
+}
+
 inline OnePoleFilter* OnePoleFilter::getSlave() {
 	return slave;
 }
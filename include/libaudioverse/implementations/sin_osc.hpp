@@ -7,6 +7,8 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #pragma once
 #include <math.h>
 #include "../private/constants.hpp"
+#include "../private/kernels.hpp"
+#include <algorithm>
 
 namespace libaudioverse_implementation {
 
@@ -90,6 +92,39 @@ class SinOsc {
 		phaseWrap = p;
 	}
 	
+	//Tick up to 4 oscillators at once, one per SIMD lane, writing length samples to each of outputs.
+	//The phase wrap must be 1.  The output matches tick up to rounding in the phase, which only shows after a resync.
+	static void tickLanes(int count, SinOsc** oscillators, int length, float** outputs) {
+		double state[16];
+		float* laneOutputs[4];
+		int done = 0;
+		while(done < length) {
+			//Do the start of the first tick, and find how many ticks can go before any oscillator needs to resync.
+			int ticks = length-done;
+			for(int i = 0; i < count; i++) {
+				SinOsc &o = *oscillators[i];
+				if(o.phase > o.phaseWrap) o.phase -= floor(o.phase/o.phaseWrap)*o.phaseWrap;
+				o.resyncCounter--;
+				if(o.resyncCounter == 0) o.doResync();
+				ticks = std::min(ticks, o.resyncCounter);
+				state[i] = o.sx;
+				state[4+i] = o.cx;
+				state[8+i] = o.sd;
+				state[12+i] = o.cd;
+				laneOutputs[i] = outputs[i]+done;
+			}
+			sineLanesKernel(count, ticks, laneOutputs, state);
+			for(int i = 0; i < count; i++) {
+				SinOsc &o = *oscillators[i];
+				o.sx = state[i];
+				o.cx = state[4+i];
+				o.phase += o.phaseIncrement*ticks;
+				o.resyncCounter -= ticks-1;
+			}
+			done += ticks;
+		}
+	}
+	
 	private:
 	//s=sin, c=cos
 	//internal vector is right, frequency is zero.
@@ -0,0 +1,113 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#pragma once
+#include "../private/wavetables.hpp"
+#include <math.h>
+#include <memory>
+
+namespace libaudioverse_implementation {
+
+/**Plays the shared band-limited tables for one of the additive waveforms.
+
+This is a drop-in replacement for AdditiveSaw, AdditiveSquare, and AdditiveTriangle which costs one interpolated table read per sample regardless of the harmonic count.
+With a nonzero harmonic count, the output matches the additive oscillator to within interpolation error.
+When autoadjusting, the harmonic count is rounded down to a power of 2 so that all frequencies are served by the precomputed mipmap.
+*/
+
+class WavetableOscillator {
+	public:
+	WavetableOscillator(float _sr, AdditiveWaveforms _waveform);
+	float tick();
+	void reset();
+	void setFrequency(float frequency);
+	float getFrequency();
+	void setPhase(double phase);
+	double getPhase();
+	//0 means autoadjust.
+	void setHarmonics(int harmonics);
+	int getHarmonics();
+	private:
+	void readjustHarmonics();
+	void wrapPhase();
+	AdditiveWaveforms waveform;
+	std::shared_ptr<WavetableMipmap> mipmap;
+	//Only set if harmonics is nonzero.
+	std::shared_ptr<Wavetable> fixed_table = nullptr;
+	float* table = nullptr;
+	int table_length = 0, harmonics = 0;
+	float frequency = 0.0f, sr;
+	double phase = 0.0, phase_increment = 0.0;
+};
+
+inline WavetableOscillator::WavetableOscillator(float _sr, AdditiveWaveforms _waveform): waveform(_waveform), sr(_sr) {
+	mipmap = getAdditiveWavetableMipmap(waveform);
+	setFrequency(100);
+}
+
+inline float WavetableOscillator::tick() {
+	double pos = phase*table_length;
+	int i = (int)pos;
+	float w = (float)(pos-i);
+	float out = table[i]+w*(table[i+1]-table[i]);
+	phase += phase_increment;
+	if(phase >= 1.0 || phase < 0.0) wrapPhase();
+	return out;
+}
+
+inline void WavetableOscillator::reset() {
+	phase = 0.0;
+}
+
+inline void WavetableOscillator::setFrequency(float frequency) {
+	if(frequency == this->frequency) return;
+	this->frequency = frequency;
+	phase_increment = frequency/sr;
+	if(harmonics == 0) readjustHarmonics();
+}
+
+inline float WavetableOscillator::getFrequency() {
+	return frequency;
+}
+
+inline void WavetableOscillator::setPhase(double phase) {
+	this->phase = phase;
+	wrapPhase();
+}
+
+inline double WavetableOscillator::getPhase() {
+	return phase;
+}
+
+inline void WavetableOscillator::setHarmonics(int harmonics) {
+	if(harmonics == this->harmonics && table) return;
+	this->harmonics = harmonics;
+	//Fixed counts may not be a power of 2, so they get their own table.
+	//This can build one, so it should happen on property changes, not per sample.
+	if(harmonics) fixed_table = getAdditiveWavetable(waveform, harmonics);
+	else fixed_table = nullptr;
+	readjustHarmonics();
+}
+
+inline int WavetableOscillator::getHarmonics() {
+	return harmonics;
+}
+
+inline void WavetableOscillator::wrapPhase() {
+	phase -= floor(phase);
+	//Tiny negative phases round up to exactly 1, which would read past the guard sample.
+	if(phase >= 1.0) phase = 0.0;
+}
+
+inline void WavetableOscillator::readjustHarmonics() {
+	Wavetable* t;
+	if(fixed_table) t = fixed_table.get();
+	else t = mipmap->getTableForHarmonics(computeAdditiveHarmonics(waveform, sr, frequency));
+	table = t->data;
+	table_length = t->length;
+}
+
+}
\ No newline at end of file
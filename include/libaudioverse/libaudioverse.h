@@ -218,6 +218,10 @@ Lav_PUBLIC_FUNCTION LavError Lav_serverWriteFile(LavHandle serverHandle, const c
 
 Lav_PUBLIC_FUNCTION LavError Lav_serverSetThreads(LavHandle serverHandle, int threads);
 Lav_PUBLIC_FUNCTION LavError Lav_serverGetThreads(LavHandle serverHandle, int* destination);
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetMinimumPhaseHrtfLength(LavHandle serverHandle, int length);
+Lav_PUBLIC_FUNCTION LavError Lav_serverGetMinimumPhaseHrtfLength(LavHandle serverHandle, int* destination);
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetHrtfGrid(LavHandle serverHandle, float azimuthStep, float elevationStep);
+Lav_PUBLIC_FUNCTION LavError Lav_serverGetHrtfGrid(LavHandle serverHandle, float* destinationAzimuthStep, float* destinationElevationStep);
 
 Lav_PUBLIC_FUNCTION LavError Lav_serverCallIn(LavHandle serverHandle, double when, int inAudioThread, LavTimeCallback cb, void* userdata);
 
@@ -341,6 +345,7 @@ Lav_PUBLIC_FUNCTION LavError Lav_recorderNodeStartRecording(LavHandle nodeHandle
 Lav_PUBLIC_FUNCTION LavError Lav_recorderNodeStopRecording(LavHandle nodeHandle);
 
 Lav_PUBLIC_FUNCTION LavError Lav_createConvolverNode(LavHandle serverHandle, int channels, LavHandle* destination);
+Lav_PUBLIC_FUNCTION LavError Lav_convolverNodeSetTaps(LavHandle nodeHandle, int count, int* delays, float* gains);
 
 Lav_PUBLIC_FUNCTION LavError Lav_createFftConvolverNode(LavHandle serverHandle, int channels, LavHandle* destination);
 Lav_PUBLIC_FUNCTION LavError Lav_fftConvolverNodeSetResponse(LavHandle nodeHandle, int channel, int length, float* response);
@@ -53,6 +53,11 @@ enum lav_SAW_PROPERTIES {
 	Lav_SAW_HARMONICS = -3,
 };
 
+//Shared by the additive saw, square, and triangle.
+enum Lav_ADDITIVE_OSCILLATOR_PROPERTIES {
+	Lav_ADDITIVE_OSCILLATOR_USE_WAVETABLE = -210,
+};
+
 enum Lav_NOISE_PROPERTIES {
 	Lav_NOISE_NOISE_TYPE = -1,
 	Lav_NOISE_SHOULD_NORMALIZE = -2,
@@ -153,6 +158,17 @@ enum Lav_CONVOLVER_PROPERTIES {
 	Lav_CONVOLVER_IMPULSE_RESPONSE = -1,
 };
 
+enum Lav_FFT_CONVOLVER_PROPERTIES {
+	Lav_FFT_CONVOLVER_MODE = -1,
+	Lav_FFT_CONVOLVER_SHARED_INPUT = -2,
+	Lav_FFT_CONVOLVER_CROSSFADE = -3,
+};
+
+enum Lav_FFT_CONVOLVER_MODES {
+	Lav_FFT_CONVOLVER_MODE_AUTOMATIC = 0,
+	Lav_FFT_CONVOLVER_MODE_NONUNIFORM = 1,
+};
+
 enum Lav_THREE_BAND_EQ_PROPERTIES {
 	Lav_THREE_BAND_EQ_HIGHBAND_DBGAIN = -1,
 	Lav_THREE_BAND_EQ_HIGHBAND_FREQUENCY = -2,
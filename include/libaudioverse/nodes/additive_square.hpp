@@ -7,6 +7,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #pragma once
 #include "../private/node.hpp"
 #include "../implementations/additive_square.hpp"
+#include "../implementations/wavetable_oscillator.hpp"
 #include <memory>
 
 namespace libaudioverse_implementation {
@@ -19,6 +20,11 @@ class AdditiveSquareNode: public Node {
 	virtual void process() override;
 	virtual void reset() override;
 	AdditiveSquare oscillator;
+	WavetableOscillator wavetable;
+	bool use_wavetable = false;
+	private:
+	template<typename OscillatorT>
+	void processOscillator(OscillatorT &osc);
 };
 
 std::shared_ptr<Node> createAdditiveSquareNode(std::shared_ptr<Server> server);
@@ -18,11 +18,19 @@ class BiquadNode: public Node {
 	public:
 	BiquadNode(std::shared_ptr<Server> sim, unsigned int channels);
 	void process();
+	bool canBatch() override {return true;}
+	void processBatch(int count, Node** nodes) override;
 	void reconfigure();
+	//True if the frequency, q or gain is a-rate.
+	bool isModulated();
+	//Redesigns every BIQUAD_MODULATION_INTERVAL samples.
+	void processModulated();
 	void reset() override;
 	private:
 	MultichannelFilterBank<BiquadFilter> bank;
 	int prev_type;
+	//Set by processModulated, so that the first static block redesigns exactly.
+	bool was_modulated = false;
 };
 
 std::shared_ptr<Node> createBiquadNode(std::shared_ptr<Server> server, unsigned int channels);
@@ -16,6 +16,8 @@ namespace libaudioverse_implementation {
 
 class Server;
 
+//This doesn't batch: each player reads a different buffer at a different position, so lanes would need a gather per sample, which SSE2 doesn't have, and only a multiply and add per sample would be shared.
+//At rate 1 it's already a copy.
 class BufferNode: public Node {
 	public:
 	BufferNode(std::shared_ptr<Server> server);
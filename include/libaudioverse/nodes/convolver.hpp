@@ -11,7 +11,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 namespace libaudioverse_implementation {
 
 class Server;
-class BlockConvolver;
+class AutomaticConvolver;
 
 class ConvolverNode: public Node {
 	public:
@@ -19,8 +19,10 @@ class ConvolverNode: public Node {
 	~ConvolverNode();
 	virtual void process();
 	void setImpulseResponse();
+	//Replaces the impulse response until it's next set.
+	void setTaps(int count, int* delays, float* gains);
 	int channels;
-	BlockConvolver **convolvers;
+	AutomaticConvolver **convolvers;
 };
 
 std::shared_ptr<Node> createConvolverNode(std::shared_ptr<Server> server, int channels);
@@ -10,27 +10,19 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 
 namespace libaudioverse_implementation {
 class Server;
-class InterpolatedDelayLine;
-class OnePoleFilter;
-class InterpolatedRandomGenerator;
+class FdnReverbCore;
 
 class FdnReverbNode: public Node {
 	public:
 	FdnReverbNode(std::shared_ptr<Server> sim);
 	~FdnReverbNode();
 	void process();
-	void modulateLines();
 	void reconfigureModel();
 	float feedback_gains[8];
-	OnePoleFilter** lowpass_filters = nullptr;
-	InterpolatedDelayLine** delay_lines = nullptr;
-	InterpolatedRandomGenerator **delay_line_modulators;
+	FdnReverbCore* core = nullptr;
 	//We keep a record of these for debugging and other purposes.
 	//These are the delays based off the current density.
 	float current_delays[8];
-	//Modulation state.
-	bool needs_modulation = false;
-	float modulation_depth = 0.0f; //equal to the property times the modulation duration from above.
 };
 
 std::shared_ptr<Node> createFdnReverbNode(std::shared_ptr<Server> server);
@@ -7,11 +7,29 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #pragma once
 #include "../private/node.hpp"
 #include <memory>
+#include <vector>
+#include <string>
 
 namespace libaudioverse_implementation {
 
 class Server;
-class FftConvolver;
+class PartitionedConvolver;
+class PartitionedResponse;
+class NonUniformConvolver;
+
+//Everything expensive about setting a response, prepared without holding the node's lock.
+struct FftConvolverNodeResponse {
+	//The mode this was prepared for.
+	int mode = 0;
+	std::vector<float> samples;
+	std::shared_ptr<PartitionedResponse> partitioned;
+	std::unique_ptr<NonUniformConvolver> nonuniform;
+	//What commitResponse replaced, so that it's freed after unlocking.
+	std::vector<std::shared_ptr<PartitionedResponse>> displaced;
+	FftConvolverNodeResponse() = default;
+	FftConvolverNodeResponse(FftConvolverNodeResponse&&) = default;
+	~FftConvolverNodeResponse();
+};
 
 class FftConvolverNode: public Node {
 	public:
@@ -19,9 +37,23 @@ class FftConvolverNode: public Node {
 	~FftConvolverNode();
 	virtual void process();
 	void setResponse(int channel, int length, float* response);
-	void setResponseFromFile(std::string path, int fileChannel, int convolverChannel);
+	//Reads the file and resamples it to the server's rate.  Doesn't need the lock.
+	std::vector<float> readResponseFile(std::string path, int fileChannel);
+	//Doesn't need the lock, so that the public API can do this while audio keeps playing.
+	FftConvolverNodeResponse prepareResponse(int mode, int length, float* response);
+	//Needs the lock, but is cheap.  Leaves whatever the response replaced in prepared, for the caller to destroy after unlocking.
+	void commitResponse(int channel, FftConvolverNodeResponse &prepared);
+	//Hands the saved response for channel to whichever convolver the mode and shared input call for.
+	void applyResponse(int channel);
 	int channels;
-	FftConvolver **convolvers;
+	//Used in Lav_FFT_CONVOLVER_MODE_AUTOMATIC without shared input, otherwise null.
+	PartitionedConvolver **partitioned_convolvers;
+	//Used for all channels in Lav_FFT_CONVOLVER_MODE_NONUNIFORM, otherwise null.
+	NonUniformConvolver **nonuniform_convolvers;
+	//Holds every channel's response when the input is shared and the mode is automatic, otherwise null.
+	PartitionedConvolver *shared_convolver = nullptr;
+	//The responses, kept so that changing the mode can reapply them.
+	std::vector<std::vector<float>> responses;
 };
 
 std::shared_ptr<Node> createFftConvolverNode(std::shared_ptr<Server> server, int channels);
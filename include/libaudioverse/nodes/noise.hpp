@@ -6,8 +6,7 @@ A copy of both licenses may be found in license.gpl and license.mpl at the root
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #pragma once
 #include "../private/node.hpp"
-#include "../implementations/iir.hpp"
-#include <random>
+#include "../implementations/noise_generator.hpp"
 #include <memory>
 
 namespace libaudioverse_implementation {
@@ -19,10 +18,11 @@ class NoiseNode: public Node {
 	void white();
 	void pink();
 	void brown();
-	std::minstd_rand random_number_generator;
-	std::normal_distribution<float> normal_distribution;
-	IIRFilter pinkifier; //filter to turn white noise into pink noise.
-	IIRFilter brownifier; //and likewise for brown.
+	//Normalizes the output buffer by the running maximum if should_normalize is set.
+	void normalize(float &max);
+	NoiseGenerator generator;
+	PartialFractionFilter pinkifier; //filter to turn white noise into pink noise.
+	PartialFractionFilter brownifier; //and likewise for brown.
 	float pink_max = 0.0f, brown_max = 0.0f; //used for normalizing noise.
 };
 
@@ -18,6 +18,8 @@ class OnePoleFilterNode: public Node {
 	public:
 	OnePoleFilterNode(std::shared_ptr<Server> sim, int channels);
 	void process() override;
+	bool canBatch() override {return true;}
+	void processBatch(int count, Node** nodes) override;
 	void reconfigureFilters();
 	MultichannelFilterBank<OnePoleFilter> bank;
 };
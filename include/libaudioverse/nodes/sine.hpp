@@ -17,6 +17,8 @@ class SineNode: public Node {
 	public:
 	SineNode(std::shared_ptr<Server> server);
 	virtual void process();
+	bool canBatch() override {return true;}
+	void processBatch(int count, Node** nodes) override;
 	virtual void reset() override;
 	SinOsc oscillator;
 };
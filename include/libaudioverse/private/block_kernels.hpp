@@ -0,0 +1,29 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#pragma once
+
+namespace libaudioverse_implementation {
+
+/**Kernels instantiated for one block size, so that their loops have constant bounds and no remainders.
+The server picks a table for its block size when it is created; nodes and connections keep a pointer to it.
+The signatures match the general kernels and length must be the server's block size.
+Entries that don't measurably beat the general kernels point at them instead.*/
+class BlockKernels {
+	public:
+	int block_size;
+	void (*addition)(int length, float* a1, float* a2, float* dest);
+	void (*scalarAddition)(int length, float c, float* a1, float* dest);
+	void (*scalarMultiplication)(int length, float c, float* a1, float* dest);
+	void (*multiplicationAddition)(int length, float c, float* a1, float* a2, float* dest);
+	//multiplicationAddition on each of channels buffers.  The layouts 1, 2, 4, 6 and 8 are unrolled.
+	void (*multichannelMultiplicationAddition)(int channels, int length, float c, float** a1, float** a2, float** dest);
+};
+
+//Fully specialized for 64; 128 and 256 specialize only multichannelMultiplicationAddition.
+const BlockKernels* selectBlockKernels(int blockSize);
+
+}
\ No newline at end of file
@@ -13,6 +13,7 @@ namespace libaudioverse_implementation {
 
 class Node;
 class Server;
+class BlockKernels;
 
 //we need weak pointers to this in OutputConnection.
 class InputConnection;
@@ -34,6 +35,7 @@ class OutputConnection {
 	private:
 	Node* node = nullptr;
 	int start, count, block_size;
+	const BlockKernels* block_kernels = nullptr;
 	std::set<std::weak_ptr<InputConnection>, std::owner_less<std::weak_ptr<InputConnection>>> connected_to;
 };
 
@@ -5,6 +5,7 @@ You may use this code under the terms of either license at your option.
 A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #pragma once
+#include <vector>
 
 namespace libaudioverse_implementation {
 
@@ -35,4 +36,18 @@ void hadamard(int n, float* buffer, bool shouldNormalize=true);
 //Fill a buffer with a matrix representing a reflectiona bout a plane whose normal is (1, 1, 1, 1...)
 //This is also known as a householder matrix.
 void householder(int n, float* buffer, bool shouldNormalize =true);
+
+//Multiply a vector by the unnormalized hadamard matrix of order n (n must be a power of 2) in place, in O(n log n).
+void fastWalshHadamard(int n, float* buffer);
+
+//Try to write an n by n matrix as diag(rowGains)*s*diag(columnGains).
+//For the first, s is the unnormalized hadamard matrix; for the second, it is the householder reflection I-(2/n)*ones.
+//These recognize the output of hadamard and householder with any gains applied to rows or columns, and return false for anything else.
+bool factorScaledHadamard(int n, const float* matrix, float* rowGains, float* columnGains);
+bool factorScaledHouseholder(int n, const float* matrix, float* rowGains, float* columnGains);
+
+//Factor a transfer function, with numerator and denominator in powers of z^-1, into cascaded second-order sections.
+//Each section is 5 doubles: b0, b1, b2, a1, a2 with a0 of 1.  The overall gain is on the first section.
+//Returns false and leaves sections alone if the roots can't be found accurately enough to reproduce the original coefficients.
+bool factorSecondOrderSections(int numeratorLength, const double* numerator, int denominatorLength, const double* denominator, std::vector<double> &sections);
 }
\ No newline at end of file
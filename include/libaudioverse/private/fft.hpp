@@ -0,0 +1,44 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#pragma once
+#include <memory>
+#include <vector>
+
+namespace libaudioverse_implementation {
+
+/**Real ffts of power-of-two sizes, with spectra split into real and imaginary arrays of size/2+1 bins so that spectral math is plain SIMD.
+Plans hold only precomputed tables, so one plan is shared by everything that needs its size; get them from getFftPlan.
+Sizes must be powers of 2 and at least 2.*/
+class FftPlan {
+	public:
+	FftPlan(int size);
+	int getSize();
+	int getBinCount();
+	//Input is size samples.
+	void forward(const float* input, float* real, float* imag);
+	//Not normalized: the output is size times the signal that forward was given.
+	void inverse(const float* real, const float* imag, float* output);
+	private:
+	//A complex fft of size/2, ping-ponging between real/imag and otherReal/otherImag; real and imag are left pointing at the result.
+	void complexForward(float* &real, float* &imag, float* otherReal, float* otherImag);
+	int size, half;
+	//Twiddles for each pass of the complex fft, back to back; the pass with stride 2 stores each twice.
+	std::vector<float> twiddle_real, twiddle_imag;
+	std::vector<int> twiddle_offsets;
+	//exp(-2 pi i k/size), for splitting the complex fft into the real one.
+	std::vector<float> split_real, split_imag;
+};
+
+//Process-wide cache: every convolver of the same size shares one plan.  Thread safe.
+std::shared_ptr<FftPlan> getFftPlan(int size);
+//The smallest power of two at least n.
+int fftSizeAtLeast(int n);
+
+void initializeFftPlanCache();
+void shutdownFftPlanCache();
+
+}
\ No newline at end of file
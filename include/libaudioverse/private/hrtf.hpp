@@ -8,10 +8,47 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <powercores/thread_local_variable.hpp>
 #include <string>
 #include <memory>
+#include <vector>
+#include <map>
+#include <mutex>
 #include <kiss_fftr.h>
 
 namespace libaudioverse_implementation {
 
+class PartitionedResponse;
+class Server;
+
+//Limits on what servers may ask for, so that a mistake can't spend gigabytes or minutes while the hrtf caches are locked.
+//Hrirs are a few hundred samples; minimum phase versions are shorter.
+const int HRTF_MAX_MINIMUM_PHASE_LENGTH = 1024;
+//In degrees.  Keeps the point count of a grid from overflowing; HRTF_MAX_GRID_SIZE is the real limit.
+const float HRTF_MIN_GRID_STEP = 0.1f;
+//In bytes.  At the longest minimum phase length this still allows 1 degree of azimuth by 5 of elevation.
+const double HRTF_MAX_GRID_SIZE = 64.0*1024*1024;
+//The bytes of hrirs buildGrid stores for these steps, over elevationRange degrees of elevation.
+//A double, so that it can't overflow for any step.
+double computeHrtfGridSize(float azimuthStep, float elevationStep, float elevationRange, int length);
+
+//How an hrtf is prepared when it's loaded.  Hrtfs loaded with different options are different HrtfData.
+struct HrtfOptions {
+	//0 leaves the hrirs as they are; see HrtfData::makeMinimumPhase.
+	int minimum_phase_length = 0;
+	//0 for either means no grid; see HrtfData::buildGrid.
+	float grid_azimuth_step = 0.0f, grid_elevation_step = 0.0f;
+};
+
+bool operator<(const HrtfOptions &a, const HrtfOptions &b);
+
+//The spectra of every hrir for one block size, indexed by elevation and then azimuth.
+typedef std::vector<std::vector<std::shared_ptr<PartitionedResponse>>> HrirSpectra;
+
+//The hrirs a direction falls between: two elevations, and two azimuths on each.
+struct HrirWeights {
+	int elevations[2], azimuths[2][2];
+	double elevation_weights[2];
+	float azimuth_weights[2][2];
+};
+
 class HrtfData {
 	public:
 	HrtfData();
@@ -22,6 +59,31 @@ class HrtfData {
 	//warning: writes directly to the output destination, doesn't allocate a new one.
 	void computeCoefficientsStereo(float elevation, float azimuth, float* left, float* right);
 
+	//The same, but mixes spectra from getSpectra into responses the caller owns, so that nothing is allocated.
+	void computeSpectraMono(float elevation, float azimuth, HrirSpectra &spectra, PartitionedResponse* out);
+	void computeSpectraStereo(float elevation, float azimuth, HrirSpectra &spectra, PartitionedResponse* left, PartitionedResponse* right);
+	//Thread safe.  Transforms every hrir the first time a block size asks, and keeps them for the next.
+	std::shared_ptr<HrirSpectra> getSpectra(int blockSize);
+
+	//Converts every hrir to minimum phase, truncated to length, and keeps the delay it had separately.
+	//Call after loading and before anything else uses this.
+	void makeMinimumPhase(int length);
+	//True after makeMinimumPhase, in which case panners have to apply these delays themselves.
+	bool hasDelays();
+	//In samples, interpolated like the coefficients.
+	void computeDelaysStereo(float elevation, float azimuth, float &left, float &right);
+	float getMaxDelay();
+
+	//Precomputes the coefficients, and delays if there are any, on a grid of directions, so that the stereo functions only have to snap to the nearest one.
+	//Steps are in degrees, and are shrunk to divide the range evenly.  Call after loading and after makeMinimumPhase.
+	//Errors without allocating if the grid would be bigger than HRTF_MAX_GRID_SIZE.
+	void buildGrid(float azimuthStep, float elevationStep);
+	bool hasGrid();
+	//Points into the grid, for as long as this HrtfData lives; don't write through them.
+	void getGridCoefficientsStereo(float elevation, float azimuth, float* &left, float* &right);
+	//In bytes.
+	std::size_t getGridSize();
+
 	//load from a file.
 	void loadFromFile(std::string path, unsigned int forSr);
 	void loadFromDefault(unsigned int forSr);
@@ -30,6 +92,10 @@ class HrtfData {
 	//get the hrir's length.
 	int getLength();
 	private:
+	HrirWeights computeWeights(float elevation, float azimuth);
+	float computeDelayMono(float elevation, float azimuth);
+	//Of the nearest grid point to this direction for the right ear.
+	int gridIndex(float elevation, float azimuth);
 	float* createTemporaryBuffer();
 	void freeTemporaryBuffer(float* b);
 	int elev_count = 0, hrir_count = 0, hrir_length = 0;
@@ -37,8 +103,17 @@ class HrtfData {
 	int *azimuth_counts = nullptr;
 	int samplerate = 0;
 	float ***hrirs = nullptr;
+	//Indexed like hrirs, relative to the earliest.
+	float **delays = nullptr;
+	float max_delay = 0.0f;
+	//Azimuths vary fastest; entries are hrir_length apart.
+	std::vector<float> grid_coefficients, grid_delays;
+	int grid_azimuth_count = 0, grid_elevation_count = 0;
+	float grid_azimuth_step = 0.0f, grid_elevation_step = 0.0f;
 	//used for crossfading so we don't clobber the heap.
 	powercores::ThreadLocalVariable<float*> temporary_buffer1, temporary_buffer2;
+	std::map<int, std::shared_ptr<HrirSpectra>> spectra;
+	std::mutex spectra_mutex;
 };
 
 void initializeHrtfCaches();
@@ -46,5 +121,9 @@ void shutdownHrtfCaches();
 
 //This is threadsafe in and of itself, and will return hrtfs from a cache if it can.
 //Either load from a file or our internal default.
-std::shared_ptr<HrtfData> createHrtfFromString(std::string path, int forSr);
+//If blockSize isn't 0 and HrtfPanner will use the frequency domain at that block size, the spectra it needs are built now rather than when it's constructed.
+std::shared_ptr<HrtfData> createHrtfFromString(std::string path, int forSr, const HrtfOptions &options = HrtfOptions(), int blockSize = 0);
+//With the server's samplerate, block size and options.
+//Locks the server only to read those; call it without the server locked, so that loading doesn't stall audio.
+std::shared_ptr<HrtfData> createHrtfForServer(std::string path, std::shared_ptr<Server> server);
 }
\ No newline at end of file
@@ -30,11 +30,16 @@ class  Job: public ExternalObject {
 	virtual ~Job() {}
 	virtual void execute() {}
 	virtual bool canCull() {return false;}
+	//Adjacent jobs of the same type in a bin which can batch and don't depend on each other are run together, through the first one's executeBatch.
+	virtual bool canBatch() {return false;}
+	//The default just executes them one at a time.
+	virtual void executeBatch(int count, std::shared_ptr<Job>* jobs);
 	private:
 	bool job_recorded = false;
 	friend void binner(std::shared_ptr<Job> job, int tag, std::map<int, std::vector<std::shared_ptr<Job>>> &destination);
 	friend class Planner;
 	friend void jobExecutor(std::shared_ptr<Job> &j); //Used by the planner to run jobs.
+	friend void batchExecutor(int count, std::shared_ptr<Job>* jobs);
 };
 
 }
\ No newline at end of file
@@ -22,6 +22,8 @@ void additionKernel(int length, float* a1, float* a2, float* dest);
 void scalarAdditionKernel(int length, float c, float*a1, float* dest);
 void scalarMultiplicationKernel(int length, float c, float* a1, float* dest);
 void multiplicationKernel(int length, float* a1, float* a2, float* dest);
+//Multiply by a linearly changing gain: dest[i] = a1[i]*(start+i*delta).
+void rampMultiplicationKernel(int length, float start, float delta, float* a1, float* dest);
 
 //multiply a1 by c, sum with a2, and store result in dest.
 //a1==dest and a2==dest are, again, safe.
@@ -31,6 +33,15 @@ void multiplicationAdditionKernel(int length, float c, float* a1, float* a2, flo
 //This implies that a1 must be at least 3 elements longer than a2.
 //Note that if a1 and a2 are the same buffers, this will be problematic; if they are, a2-a1 must be greater than 3.
 void parallelMultiplicationAdditionKernel(int length, float c1, float c2, float c3, float c4,  float* a1, float* a2, float* out);
+//Linear blend from a1 to a2: dest[i] = a1[i]+(a2[i]-a1[i])*(weight+i*delta).
+//A delta of 0 interpolates between two signals, otherwise this is a crossfade.  Any of the buffers may be the same.
+void crossfadeKernel(int length, float weight, float delta, float* a1, float* a2, float* dest);
+//Complex multiply-accumulate on arrays split into real and imaginary parts: dest += a*b.
+//Used by partitioned convolution.
+void complexMultiplicationAdditionKernel(int length, const float* ar, const float* ai, const float* br, const float* bi, float* destr, float* desti);
+//Multiply every one of the channels buffers by mul and then add add, in place, one sample of every channel at a time.
+//These are per-sample values, as held by a-rate properties.  Either may be null, in which case the constant is used instead.
+void postprocessingKernel(int channels, int length, float** buffers, const double* mul, float mulConstant, const double* add, float addConstant);
 
 /**The convolution kernel.
 The first response-1 samples of the input buffer are assumed to be a running history, so the actual length of the input buffer needs to be outputSampleCount+responseLength-1.
@@ -57,4 +68,26 @@ void staticResamplerKernel(int inputSr, int outputSr, int channels, int frames,
 
 /**Dot two vectors.*/
 float dotKernel(int length, const float* v1, const float* v2);
+
+/**Run up to 4 channels through the same kind of filter at once, one channel per SIMD lane.
+lanes is the number of channels, and inputs and outputs hold lanes pointers.  Inputs and outputs may be the same buffers.
+Coefficients and history are stored with 4 slots per value: value k of lane l is at k*4+l.
+The biquad takes b0, b1, b2, a1, a2 and history h1, h2, as in BiquadFilter.
+The one-pole takes b0, a1 and history last.
+The first-order filter takes b0, b1, a1 and history lastInput, lastOutput.
+Output is identical to ticking the filters one at a time.*/
+void biquadLanesKernel(int lanes, int length, float** inputs, float** outputs, const double* coefficients, double* history);
+void onePoleLanesKernel(int lanes, int length, float** inputs, float** outputs, const float* coefficients, float* history);
+void firstOrderLanesKernel(int lanes, int length, float** inputs, float** outputs, const float* coefficients, float* history);
+//biquadLanesKernel with coefficients shared by all lanes and moving linearly: sample i uses start[k]+(i+1)*delta[k].
+//start and delta hold b0, b1, b2, a1, a2.
+void biquadRampLanesKernel(int lanes, int length, float** inputs, float** outputs, const double* start, const double* delta, double* history);
+//The same for SinOsc's rotation, which has no input: output sin, then rotate (sin, cos) by the angle whose sin and cos are given.
+//State is sin, cos, sin of the angle, cos of the angle; only the first two change.
+void sineLanesKernel(int lanes, int length, float** outputs, double* state);
+
+/**Run one channel through a cascade of biquads, in the same direct form 2 as BiquadFilter.
+Each section has 5 coefficients (b0, b1, b2, a1, a2) and 2 history values (h1, h2), stored one section after another.
+Intermediate results stay in double precision.*/
+void biquadCascadeKernel(int sections, int length, float* input, float* output, const double* coefficients, double* history);
 }
\ No newline at end of file
@@ -6,14 +6,41 @@ A copy of both licenses may be found in license.gpl and license.mpl at the root
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #pragma once
 #include <functional>
+#include <type_traits>
 
 namespace libaudioverse_implementation {
 
 /**The following configures and manages filters using similar tricks to smart pointers.
 
 You can do mcfb->anythingOnTheFilters, as well as . to use the functions here.
+
+Filters which provide a static processLanes function are processed 4 channels at a time, one channel per SIMD lane.
+The filter objects still own their coefficients and history; processLanes gathers them once per block.
+Otherwise, filters with a process function for blocks use that, and the rest are ticked.
 */
 
+//True if filter_type has static void processLanes(int count, filter_type** filters, int length, float** inputs, float** outputs).
+template<typename filter_type>
+class FilterHasLanes {
+	template<typename T>
+	static std::true_type check(decltype(&T::processLanes));
+	template<typename T>
+	static std::false_type check(...);
+	public:
+	static const bool value = decltype(check<filter_type>(nullptr))::value;
+};
+
+//True if filter_type has void process(int length, float* input, float* output).
+template<typename filter_type>
+class FilterHasProcess {
+	template<typename T>
+	static std::true_type check(decltype(&T::process));
+	template<typename T>
+	static std::false_type check(...);
+	public:
+	static const bool value = decltype(check<filter_type>(nullptr))::value;
+};
+
 template<typename filter_type>
 class MultichannelFilterBank {
 	public:
@@ -36,6 +63,10 @@ class MultichannelFilterBank {
 	template<typename CallableT, typename... ArgsT>
 	void process(int blockSize, float** inputs, float** outputs, CallableT callable, ArgsT... args);
 	private:
+	void processChannels(int blockSize, float** inputs, float** outputs, std::true_type hasLanes);
+	void processChannels(int blockSize, float** inputs, float** outputs, std::false_type hasLanes);
+	void processChannel(filter_type* filter, int blockSize, float* input, float* output, std::true_type hasProcess);
+	void processChannel(filter_type* filter, int blockSize, float* input, float* output, std::false_type hasProcess);
 	std::function<filter_type*(void)> filter_creator; //used for type erasure.
 	filter_type* first = nullptr;
 	int channel_count = 0;
@@ -75,6 +106,7 @@ void MultichannelFilterBank<filter_type>::setChannelCount(int newCount) {
 			auto t = first;
 			first = first->getSlave();
 			delete t;
+			drop--;
 		}
 	}
 	else {
@@ -122,15 +154,70 @@ void MultichannelFilterBank<filter_type>::tick(float* inputFrame, float* outputF
 
 template<typename filter_type>
 void MultichannelFilterBank<filter_type>::process(int blockSize, float** inputs, float** outputs) {
+	processChannels(blockSize, inputs, outputs, std::integral_constant<bool, FilterHasLanes<filter_type>::value>());
+}
+
+template<typename filter_type>
+void MultichannelFilterBank<filter_type>::processChannels(int blockSize, float** inputs, float** outputs, std::true_type hasLanes) {
 	auto f = first;
 	int i = 0;
 	while(f) {
-		for(int j = 0; j < blockSize; j++) outputs[i][j] = f->tick(inputs[i][j]);
+		filter_type* lanes[4];
+		int count = 0;
+		while(f && count < 4) {
+			lanes[count] = f;
+			count++;
+			f = f->getSlave();
+		}
+		filter_type::processLanes(count, lanes, blockSize, inputs+i, outputs+i);
+		i += count;
+	}
+}
+
+//Processes the channels of several banks 4 at a time, whichever bank they belong to, so that nodes with only a channel or two still fill the lanes.
+//inputs[i] and outputs[i] are the buffers for banks[i].  Only for filters with processLanes.
+template<typename filter_type>
+void processBanksTogether(int count, MultichannelFilterBank<filter_type>** banks, int blockSize, float*** inputs, float*** outputs) {
+	filter_type* lanes[4];
+	float* laneInputs[4], *laneOutputs[4];
+	int used = 0;
+	for(int i = 0; i < count; i++) {
+		int channel = 0;
+		for(filter_type* f = banks[i]->operator->(); f; f = f->getSlave(), channel++) {
+			lanes[used] = f;
+			laneInputs[used] = inputs[i][channel];
+			laneOutputs[used] = outputs[i][channel];
+			used++;
+			if(used == 4) {
+				filter_type::processLanes(used, lanes, blockSize, laneInputs, laneOutputs);
+				used = 0;
+			}
+		}
+	}
+	if(used) filter_type::processLanes(used, lanes, blockSize, laneInputs, laneOutputs);
+}
+
+template<typename filter_type>
+void MultichannelFilterBank<filter_type>::processChannels(int blockSize, float** inputs, float** outputs, std::false_type hasLanes) {
+	auto f = first;
+	int i = 0;
+	while(f) {
+		processChannel(f, blockSize, inputs[i], outputs[i], std::integral_constant<bool, FilterHasProcess<filter_type>::value>());
 		f = f->getSlave();
 		i++;
 	}
 }
 
+template<typename filter_type>
+void MultichannelFilterBank<filter_type>::processChannel(filter_type* filter, int blockSize, float* input, float* output, std::true_type hasProcess) {
+	filter->process(blockSize, input, output);
+}
+
+template<typename filter_type>
+void MultichannelFilterBank<filter_type>::processChannel(filter_type* filter, int blockSize, float* input, float* output, std::false_type hasProcess) {
+	for(int j = 0; j < blockSize; j++) output[j] = filter->tick(input[j]);
+}
+
 template<typename filter_type>
 template<typename CallableT, typename... ArgsT>
 void MultichannelFilterBank<filter_type>::process(int blockSize, float** inputs, float** outputs, CallableT callable, ArgsT... args) {
@@ -77,11 +77,16 @@ class Node: public Job {
 	virtual void tickProperties();
 	//do not override. Handles the processing protocol (updating some globals and calling process) if needed for this tick, otherwise does nothing.
 	virtual void tick();
+	//The parts of tick before and after process.  beginTick returns false if we're paused, in which case there is nothing else to do.
+	bool beginTick();
+	void endTick();
 	//override this one instead. Default implementation merely zeros the outputs.
 	virtual void process();
-	//Apply mul and add.
-	virtual void applyMul();
-	virtual void applyAdd();
+	//Called on one node of a batch with all of them, when canBatch is overridden to return true.  All the nodes are of this node's type.
+	//The default processes them one at a time.
+	virtual void processBatch(int count, Node** nodes);
+	//Apply mul and add to all the outputs, in one pass if both are in use.
+	virtual void applyMulAdd();
 	//zero the output buffers.
 	virtual void zeroOutputBuffers();
 	virtual void zeroInputBuffers();
@@ -118,6 +123,7 @@ class Node: public Job {
 
 	//Conform to Job.
 	virtual void execute();
+	void executeBatch(int count, std::shared_ptr<Job>* jobs) override;
 
 	//True if we're paused.
 	bool canCull() override;
@@ -138,6 +144,7 @@ class Node: public Job {
 	std::vector<std::shared_ptr<OutputConnection>> output_connections;
 	bool is_processing = false, is_suspended = false;
 	int num_input_buffers = 0, num_output_buffers = 0, block_size = 0;
+	const BlockKernels* block_kernels = nullptr;
 	//used to make no-op state changes free.
 	int prev_state = Lav_NODESTATE_PLAYING;
 	int last_processed = -1; //-1 so that it's not equal to the server's tick counter, which starts at 0.
@@ -15,6 +15,10 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 /**job.hpp contains the rest of this code.*/
 
 namespace libaudioverse_implementation {
+
+//Batches are capped so that a big batch doesn't leave the other threads idle.
+const int PLANNER_MAX_BATCH = 32;
+
 class Planner {
 	public:
 	Planner();
@@ -34,7 +38,15 @@ class Planner {
 	//Initialize the strong version of the plan from the weak pointers.
 	//This can invalidate the plan.
 	void initializeStrongPlan();
+	//Orders each bin so that jobs which can batch together are adjacent, and records where the batches start.
+	void findBatches();
+	//Runs one entry of batch_starts.
+	void runBatch(std::vector<std::shared_ptr<Job>> &bin, std::vector<int> &starts, int which);
 	std::map<int, std::vector<std::shared_ptr<Job>>> plan;
+	//For every bin, the index of the first job of each batch.  Jobs which can't batch are batches of one.
+	std::map<int, std::vector<int>> batch_starts;
+	//0, 1, 2..., for mapping over batches on the thread pool.
+	std::vector<int> batch_indices;
 	std::map<int, std::vector<std::weak_ptr<Job>>> weak_plan;
 	bool is_valid = false;
 	std::weak_ptr<Job> last_start;
@@ -152,6 +152,8 @@ class Property {
 	//In other words, can we optimize the application by not computing the same thing over and over?
 	//Very important for add and mul.
 	bool needsARate();
+	//The per-sample values behind getFloatValue(i), valid when needsARate is true.
+	const double* getValueBuffer();
 	//Called by metadata.cpp to enable arate.
 	void enableARate();
 
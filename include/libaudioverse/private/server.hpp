@@ -19,6 +19,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include "../libaudioverse.h"
 #include "memory.hpp"
 #include "job.hpp"
+#include "block_kernels.hpp"
 
 namespace libaudioverse_implementation {
 
@@ -42,6 +43,8 @@ class Server: public Job {
 
 	//this is in frames of audio data.
 	unsigned int getBlockSize() { return block_size;}
+	//The kernels specialized for our block size.
+	const BlockKernels* getBlockKernels() { return block_kernels;}
 	LavError start();
 	LavError stop();
 	void associateNode(std::shared_ptr<Node> node);
@@ -77,6 +80,13 @@ class Server: public Job {
 	void setThreads(int n);
 	int getThreads();
 
+	//0 means hrtfs loaded for this server are used as they are.
+	void setMinimumPhaseHrtfLength(int length);
+	int getMinimumPhaseHrtfLength();
+	//In degrees. 0 for either means hrtfs loaded for this server interpolate every direction.
+	void setHrtfGrid(float azimuthStep, float elevationStep);
+	void getHrtfGrid(float &azimuthStep, float &elevationStep);
+
 	//called when connections are formed or lost, or when a node is deleted.
 	void invalidatePlan();
 	
@@ -109,6 +119,7 @@ class Server: public Job {
 	std::vector<float*> final_outputs;
 
 	unsigned int block_size = 0, mixahead = 0, is_started = 0;
+	const BlockKernels* block_kernels = nullptr;
 	float sr = 0.0f;
 	//if nodes die, they automatically need to be removed.  We can do said removal on next process.
 	std::set<std::weak_ptr<Node>, std::owner_less<std::weak_ptr<Node>>> nodes;
@@ -138,6 +149,8 @@ class Server: public Job {
 	
 	Planner* planner = nullptr;
 	int threads = 1;
+	int minimum_phase_hrtf_length = 0;
+	float hrtf_grid_azimuth_step = 0.0f, hrtf_grid_elevation_step = 0.0f;
 	
 	template<typename JobT, typename CallableT, typename... ArgsT>
 	friend void serverVisitDependencies(JobT&& start, CallableT&& callable, ArgsT&&... args);
@@ -0,0 +1,60 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#pragma once
+#include <memory>
+#include <vector>
+
+namespace libaudioverse_implementation {
+
+/**The waveforms the additive oscillators know how to produce.*/
+enum class AdditiveWaveforms {
+	SAW, SQUARE, TRIANGLE,
+};
+
+/**A single cycle of a band-limited waveform, containing exactly the harmonics the matching additive oscillator would sum.
+
+The table is normalized with the same factors as the additive oscillators.
+data holds length+1 samples; the last one is a copy of the first so that linear interpolation never has to wrap.
+Tables are immutable once built and are shared between every oscillator that needs them.*/
+class Wavetable {
+	public:
+	Wavetable(AdditiveWaveforms waveform, int harmonics);
+	~Wavetable();
+	AdditiveWaveforms waveform;
+	int harmonics = 0, length = 0;
+	float* data = nullptr;
+};
+
+/**One table per octave of harmonic count: level i holds 2^i harmonics.
+
+Tables do not depend on the sampling rate, only on the harmonic count, so one mipmap per waveform serves every server.
+All levels are built up front so that selecting one never allocates.*/
+class WavetableMipmap {
+	public:
+	WavetableMipmap(AdditiveWaveforms waveform);
+	//Returns the level with the most harmonics not exceeding the requested count.
+	//Counts above the top level get the top level.
+	Wavetable* getTableForHarmonics(int harmonics);
+	private:
+	std::vector<std::shared_ptr<Wavetable>> levels;
+};
+
+//The top level of the mipmap has 2^WAVETABLE_MIPMAP_LEVELS-1 harmonics, which reaches below 20 HZ at all common sampling rates.
+const int WAVETABLE_MIPMAP_LEVELS = 12;
+
+/**The harmonic count the additive oscillators pick when their harmonics property is 0.*/
+int computeAdditiveHarmonics(AdditiveWaveforms waveform, float sr, float frequency);
+
+void initializeWavetableCaches();
+void shutdownWavetableCaches();
+
+//These are threadsafe, and return cached tables when possible.
+//Getting a single table for a specific harmonic count builds it if needed, so prefer mipmaps in the audio thread.
+std::shared_ptr<Wavetable> getAdditiveWavetable(AdditiveWaveforms waveform, int harmonics);
+std::shared_ptr<WavetableMipmap> getAdditiveWavetableMipmap(AdditiveWaveforms waveform);
+
+}
\ No newline at end of file
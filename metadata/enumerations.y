@@ -97,6 +97,11 @@ enumerations:
     members:
       Lav_CHANNEL_INTERPRETATION_DISCRETE: If channel counts mismatch, don't apply mixing matrices. Either drop or fill with zeros as appropriate.
       Lav_CHANNEL_INTERPRETATION_SPEAKERS: Apply mixing matrices if needed.
+  Lav_FFT_CONVOLVER_MODES:
+    doc_description: How the {{"Lav_OBJTYPE_FFT_CONVOLVER_NODE"|node}} partitions its responses.
+    members:
+      Lav_FFT_CONVOLVER_MODE_AUTOMATIC: Uniform partitions of one block, for responses of every length.
+      Lav_FFT_CONVOLVER_MODE_NONUNIFORM: Partitions which grow with distance into the response, the larger of which are computed on background threads.  Cheapest for very long responses at small block sizes.
   Lav_NOISE_TYPES:
     doc_description: Specifies types of noise.
     members:
@@ -258,6 +258,49 @@ functions:
     category: servers
     doc_description: |
       Get the number of threads that the server is currently using.
+  Lav_serverSetMinimumPhaseHrtfLength:
+    category: servers
+    doc_description: |
+      Set how HRTFs loaded for this server afterwords are prepared.
+      
+      When 0, the default, each HRIR is used as it is in the dataset, including the leading silence that encodes the interaural time difference.
+      Otherwise, each HRIR is converted to minimum phase and truncated to this many samples, and its delay is stored separately.
+      Panning then applies the delay with an interpolated delay line and convolves with the short filter.
+      This makes convolution cheaper and keeps moving sources from smearing the delay when neighboring HRIRs are interpolated.
+      Lengths from 32 to 128 are typical at 44100 HZ.
+      
+      Nodes already created keep the HRTF they loaded.
+    params:
+      length: The length of the filters in samples, at most 1024, or 0 to disable.
+  Lav_serverGetMinimumPhaseHrtfLength:
+    category: servers
+    doc_description: |
+      Get the length set with {{"Lav_serverSetMinimumPhaseHrtfLength"|function}}.
+  Lav_serverSetHrtfGrid:
+    category: servers
+    doc_description: |
+      Precompute HRTFs loaded for this server afterwords on a grid of directions.
+      
+      When either step is 0, the default, the HRIR for every direction is interpolated from the dataset's neighboring measurements whenever a source moves.
+      Otherwise, the interpolated HRIRs are computed once at load for every grid point, and moving sources snap to the nearest one.
+      This trades memory for time: 1 degree of azimuth by 5 degrees of elevation is a few megabytes for typical datasets, and the exact size is logged.
+      Grids are shared between every node and server which load the same HRTF with the same settings.
+      Steps are shrunk as needed to divide the range evenly.
+      Each step must be 0 or at least 0.1 degrees.
+      Grids are limited to 64 MB, assuming HRIRs of 1024 samples over the full range of elevations; 1 degree of azimuth by 5 of elevation is allowed.
+      HRTFs whose grid would still be larger fail to load.
+      
+      Nodes already created keep the HRTF they loaded.
+    params:
+      azimuthStep: Degrees between grid points in azimuth.
+      elevationStep: Degrees between grid points in elevation.
+  Lav_serverGetHrtfGrid:
+    category: servers
+    doc_description: |
+      Get the steps set with {{"Lav_serverSetHrtfGrid"|function}}.
+    params:
+      destinationAzimuthStep: After a call to this function, holds the azimuth step.
+      destinationElevationStep: After a call to this function, holds the elevation step.
   Lav_serverCallIn:
     category: servers
     doc_description: |
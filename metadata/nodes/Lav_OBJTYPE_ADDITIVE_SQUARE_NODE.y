@@ -36,6 +36,16 @@ properties:
       
       While this property has no max value, any combination of frequency and harmonics that leads to aliasing will alias.
       To avoid this, make sure that {{"2*frequency*(2*harmonics-1)"|codelit}} never goes over half your chosen sampling rate.
+  Lav_ADDITIVE_OSCILLATOR_USE_WAVETABLE:
+    name: use_wavetable
+    type: boolean
+    default: 0
+    doc_description: |
+      If true, play precomputed band-limited tables instead of summing sine waves.
+      
+      The tables are shared between all additive oscillators in the process, and the cost per sample no longer depends on the number of harmonics.
+      With a nonzero harmonic count, the output is within about 0.002 of the additive output.
+      When the harmonics are automatically adjusted, the count is rounded down to a power of 2, so the highest octave of partials may be missing.
 inputs: null
 outputs:
   - [1, "A square wave."]
@@ -12,6 +12,7 @@ properties:
     type: float
     range: [0.001, INFINITY]
     default: 0.5
+    rate: a
     doc_description: |
       Q is a mathematically complex parameter, a full description of which is beyond the scope of this manual.
       Naively, Q can be interpreted as a measure of resonation.
@@ -29,6 +30,7 @@ properties:
     type: float
     range: [0, INFINITY]
     default: 2000.0
+    rate: a
     doc_description: |
       This is the frequency of interest.
       What specifically this means depends on the selected filter type; for example, it is the cutoff frequency for lowpass and highpass.
@@ -37,6 +39,7 @@ properties:
     type: float
     range: [-INFINITY, INFINITY]
     default: 0.0
+    rate: a
     doc_description: |
       This property is a the gain in decibals to be used with the peaking and shelving filters.
       It measures the gain that these filters apply to the part of the signal they boost.
@@ -50,4 +53,6 @@ doc_description: |
   This node is capable of implementing almost every filter needed for basic audio effects, including equalizers.
   For the specific equations used, see the Audio EQ Cookbook.
   It may be found at:
-  http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt
\ No newline at end of file
+  http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt
+  
+  When the frequency, Q or gain is automated or connected to, the filter is redesigned every 32 samples and the coefficients are interpolated in between.
\ No newline at end of file
@@ -8,6 +8,19 @@ properties:
     default: [1.0]
     doc_description: |
       The impulse response to convolve the input with.
+      Setting it replaces any taps set with {{"Lav_convolverNodeSetTaps"|function}}.
+extra_functions:
+  Lav_convolverNodeSetTaps:
+    doc_description: |
+      Replace the impulse response of every channel with a list of taps, each delaying the input by a number of samples and scaling it.
+      
+      This is the same as an impulse response which is zero except at each delay, but costs one multiply-add per block sample for each tap, however long the delays are.
+      Taps with the same delay are summed.
+      The taps stay in effect until the impulse_response property is next set.
+    params:
+      count: The number of taps.
+      delays: The delay of each tap in samples.  None may be negative.
+      gains: The gain of each tap.
 inputs:
   - [constructor, "The signal to be convolved."]
 outputs:
@@ -16,4 +29,7 @@ doc_name: convolver
 doc_description: |
   A simple convolver.
   
-  This implements convolution directly, without use of the FFT.
\ No newline at end of file
+  Each time the impulse response is set, this node picks whichever of direct convolution, a single FFT, uniformly partitioned FFT convolution, or a list of taps for the nonzero samples it expects to be fastest on this machine for the server's block size and the response's length.
+  Responses which are mostly zeros, such as early reflections or multitap echoes, cost one multiply-add per block sample for each nonzero sample, regardless of their length.
+  The costs this choice is based on are measured by {{"Lav_initialize"|function}}.
+  Changing to a response that needs a different method clears the convolver's history.
\ No newline at end of file
@@ -27,6 +27,9 @@ properties:
       
       The matrix is stored in row-major order.
       The supplied array must have a length equal to the square of the channels specified to the constructor.
+      
+      Hadamard matrices and householder reflections, optionally with gains applied to their rows or columns, are detected and applied much faster than arbitrary matrices.
+      Prefer them for networks with many lines.
   Lav_FDN_FILTER_TYPES:
     name: filter_types
     type: int_array
@@ -1,7 +1,36 @@
+properties:
+  Lav_FFT_CONVOLVER_MODE:
+    name: mode
+    type: int
+    value_enum: Lav_FFT_CONVOLVER_MODES
+    default: Lav_FFT_CONVOLVER_MODE_AUTOMATIC
+    doc_description: |
+      How responses are partitioned.
+      Changing this reapplies every channel's response, which clears the node's history.
+  Lav_FFT_CONVOLVER_SHARED_INPUT:
+    name: shared_input
+    type: boolean
+    default: 0
+    doc_description: |
+      If true, every channel convolves the first input channel with its own response, for example to feed a mono source through a stereo or 4-channel reverb.
+      
+      The input is transformed once for all channels, so each channel after the first costs a fraction of a separate convolver.
+      Changing this reapplies every channel's response, which clears the node's history.
+  Lav_FFT_CONVOLVER_CROSSFADE:
+    name: crossfade
+    type: boolean
+    default: 1
+    doc_description: |
+      If true, a new response fades in over one block instead of replacing the old one abruptly.
+      
+      Either way, the node's history is kept and the new response applies to everything already heard, so changing rooms changes the reverb tail too.
+      In nonuniform mode, a new response starts with a cleared history and this does nothing.
 extra_functions:
   Lav_fftConvolverNodeSetResponse:
     doc_description: |
       Set the response for a specific channel.
+      
+      The response's ffts are computed without blocking audio, and the new response is swapped in at the next block.
     params:
       channel: The channel to set the response for.
       length: The length of the response in samples.
@@ -9,6 +38,8 @@ extra_functions:
   Lav_fftConvolverNodeSetResponseFromFile:
     doc_description: |
       Set the impulse response for a specific channel of this node from a file.
+      
+      Reading, resampling and the ffts all happen without blocking audio, and the new response is swapped in at the next block.
     params:
       path: The path to the file.
       fileChannel: The channel of the file to use as the response.
@@ -21,7 +52,7 @@ doc_name: fft convolver
 doc_description: |
   A convolver for long impulse responses.
   
-  This convolver uses the overlap-add convolution algorithm.
+  This convolver uses partitioned overlap-save convolution, which adds no latency.
   It is slower than the {{"Lav_OBJTYPE_CONVOLVER_NODE"|node}} for small impulse responses.
   
   The difference between this node and the {{"Lav_OBJTYPE_CONVOLVER_NODE"|node}} is the complexity of the algorithm.
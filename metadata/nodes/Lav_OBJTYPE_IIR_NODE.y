@@ -16,4 +16,7 @@ doc_name: IIR filter
 doc_description: |
   Implements arbetrary IIR filters.
   The only restriction on the filter is that the first element of the denominator must be nonzero.
-  To configure this node, use the function Lav_iirNodeSetCoefficients.
\ No newline at end of file
+  To configure this node, use the function Lav_iirNodeSetCoefficients.
+  
+  Where possible, the filter is factored into a cascade of second-order sections, which is both faster and much less sensitive to rounding error for high orders.
+  If the roots of the transfer function can't be found accurately, or factoring would produce an unstable section, the coefficients are used directly.
\ No newline at end of file
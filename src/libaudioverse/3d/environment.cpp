@@ -208,8 +208,8 @@ int EnvironmentNode::getEffectSendCount() {
 Lav_PUBLIC_FUNCTION LavError Lav_createEnvironmentNode(LavHandle serverHandle, const char*hrtfPath, LavHandle* destination) {
 	PUB_BEGIN
 	auto server = incomingObject<Server>(serverHandle);
+	auto hrtf = createHrtfForServer(hrtfPath, server);
 	LOCK(*server);
-	auto hrtf = createHrtfFromString(hrtfPath, server->getSr());
 	auto retval = createEnvironmentNode(server, hrtf);
 	*destination = outgoingObject<Node>(retval);
 	PUB_END
@@ -9,7 +9,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/3d/environment.hpp>
 #include <libaudioverse/implementations/amplitude_panner.hpp>
 #include <libaudioverse/implementations/multipanner.hpp>
-#include <libaudioverse/implementations/biquad.hpp>
+#include <libaudioverse/implementations/block_biquad.hpp>
 #include <libaudioverse/private/properties.hpp>
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/constants.hpp>
@@ -178,7 +178,7 @@ void SourceNode::process() {
 	float* ws = source_workspace.get(block_size*9);
 	float* occluded = ws;
 	float* panBuffers[] = {ws+block_size, ws+2*block_size, ws+3*block_size, ws+4*block_size, ws+5*block_size, ws+6*block_size, ws+7*block_size, ws+8*block_size};
-	for(int i = 0; i < block_size; i++) occluded[i] = occlusion_filter.tick(input_buffers[0][i]);
+	occlusion_filter.process(block_size, input_buffers[0], occluded);
 
 	int channels = 0;
 	//The following could be replaced with a multipanner.
@@ -205,15 +205,16 @@ void SourceNode::process() {
 		channels = 8;
 		break;
 	}
-	for(int i = 0; i < channels; i++) if(panBuffers[i]) multiplicationAdditionKernel(block_size, dry_gain, panBuffers[i], environment->source_buffers[i], environment->source_buffers[i]);
+	float** sourceBuffers = &environment->source_buffers[0];
+	block_kernels->multichannelMultiplicationAddition(channels, block_size, dry_gain, panBuffers, sourceBuffers, sourceBuffers);
 	for(auto &s: fed_effects) {
 		auto &send = environment->getEffectSend(s.first);
 		auto &p = s.second;
 		float g = send.is_reverb ? reverb_gain : dry_gain;
-		if(send.channels == 1) multiplicationAdditionKernel(block_size, g, occluded, environment->source_buffers[send.start], environment->source_buffers[send.start]);
+		if(send.channels == 1) block_kernels->multiplicationAddition(block_size, g, occluded, sourceBuffers[send.start], sourceBuffers[send.start]);
 		else {
 			p->pan(occluded, panBuffers);
-			for(int i = 0; i < send.channels; i++) multiplicationAdditionKernel(block_size, g, panBuffers[i], environment->source_buffers[send.start+i], environment->source_buffers[send.start+i]);
+			block_kernels->multichannelMultiplicationAddition(send.channels, block_size, g, panBuffers, sourceBuffers+send.start, sourceBuffers+send.start);
 		}
 	}
 }
@@ -28,6 +28,7 @@ OutputConnection::OutputConnection(std::shared_ptr<Server> server, Node* node, i
 	this->start =start;
 	this->count = count;
 	this->block_size = server->getBlockSize();
+	block_kernels = server->getBlockKernels();
 }
 
 void OutputConnection::add(int inputBufferCount, float** inputBuffers, bool shouldApplyMixingMatrix) {
@@ -44,7 +45,7 @@ void OutputConnection::add(int inputBufferCount, float** inputBuffers, bool shou
 	}
 	else { //copy and drop.
 		int channelsToAdd =std::min(count, inputBufferCount);
-		for(int i=0; i < channelsToAdd; i++) additionKernel(block_size, outputArray[i+start], inputBuffers[i], inputBuffers[i]);
+		for(int i=0; i < channelsToAdd; i++) block_kernels->addition(block_size, outputArray[i+start], inputBuffers[i], inputBuffers[i]);
 	}
 }
 
@@ -0,0 +1,273 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+/**A real fft of size n is a complex fft of size n/2 over the even and odd samples, followed by one pass to separate their spectra.
+The complex fft is radix 2 Stockham, which never needs a bit reversal and keeps every pass a contiguous sweep over split real and imaginary arrays.*/
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/private/macros.hpp>
+#include <libaudioverse/private/error.hpp>
+#include <libaudioverse/private/constants.hpp>
+#include <libaudioverse/libaudioverse.h>
+#include <math.h>
+#include <utility>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+#include <xmmintrin.h>
+#endif
+
+namespace libaudioverse_implementation {
+
+//Signals of n samples with stride s, so that yr[q+s*2p] and yr[q+s*(2p+1)] are the butterflies of xr[q+s*p] and xr[q+s*(p+m)].
+//The twiddle for p is at p, except in the stride 2 pass where it's stored twice and is at 2p.
+void fftPassSimple(int n, int s, const float* twr, const float* twi, const float* xr, const float* xi, float* yr, float* yi) {
+	int m = n/2, repeat = s == 2 ? 2 : 1;
+	for(int p = 0; p < m; p++) {
+		float wr = twr[p*repeat], wi = twi[p*repeat];
+		for(int q = 0; q < s; q++) {
+			int a = q+s*p, b = q+s*(p+m), y0 = q+s*2*p, y1 = y0+s;
+			float dr = xr[a]-xr[b], di = xi[a]-xi[b];
+			yr[y0] = xr[a]+xr[b];
+			yi[y0] = xi[a]+xi[b];
+			yr[y1] = dr*wr-di*wi;
+			yi[y1] = dr*wi+di*wr;
+		}
+	}
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+void fftPass(int n, int s, const float* twr, const float* twi, const float* xr, const float* xi, float* yr, float* yi) {
+	int m = n/2;
+	if(s >= 4) {
+		for(int p = 0; p < m; p++) {
+			__m128 wr = _mm_set1_ps(twr[p]), wi = _mm_set1_ps(twi[p]);
+			int a = s*p, b = s*(p+m), y0 = s*2*p, y1 = y0+s;
+			for(int q = 0; q < s; q += 4) {
+				__m128 ar = _mm_loadu_ps(xr+a+q), ai = _mm_loadu_ps(xi+a+q);
+				__m128 br = _mm_loadu_ps(xr+b+q), bi = _mm_loadu_ps(xi+b+q);
+				__m128 dr = _mm_sub_ps(ar, br), di = _mm_sub_ps(ai, bi);
+				_mm_storeu_ps(yr+y0+q, _mm_add_ps(ar, br));
+				_mm_storeu_ps(yi+y0+q, _mm_add_ps(ai, bi));
+				_mm_storeu_ps(yr+y1+q, _mm_sub_ps(_mm_mul_ps(dr, wr), _mm_mul_ps(di, wi)));
+				_mm_storeu_ps(yi+y1+q, _mm_add_ps(_mm_mul_ps(dr, wi), _mm_mul_ps(di, wr)));
+			}
+		}
+	}
+	else if(s == 2 && m >= 2) {
+		//Two values of p at once; each output register is both q of one p, sums then differences.
+		for(int p = 0; p < m; p += 2) {
+			__m128 wr = _mm_loadu_ps(twr+2*p), wi = _mm_loadu_ps(twi+2*p);
+			__m128 ar = _mm_loadu_ps(xr+2*p), ai = _mm_loadu_ps(xi+2*p);
+			__m128 br = _mm_loadu_ps(xr+2*(p+m)), bi = _mm_loadu_ps(xi+2*(p+m));
+			__m128 sr = _mm_add_ps(ar, br), si = _mm_add_ps(ai, bi);
+			__m128 dr = _mm_sub_ps(ar, br), di = _mm_sub_ps(ai, bi);
+			__m128 tr = _mm_sub_ps(_mm_mul_ps(dr, wr), _mm_mul_ps(di, wi));
+			__m128 ti = _mm_add_ps(_mm_mul_ps(dr, wi), _mm_mul_ps(di, wr));
+			_mm_storeu_ps(yr+4*p, _mm_movelh_ps(sr, tr));
+			_mm_storeu_ps(yi+4*p, _mm_movelh_ps(si, ti));
+			_mm_storeu_ps(yr+4*p+4, _mm_movehl_ps(tr, sr));
+			_mm_storeu_ps(yi+4*p+4, _mm_movehl_ps(ti, si));
+		}
+	}
+	else if(s == 1 && m >= 4) {
+		//Four values of p at once, interleaving sums and differences on the way out.
+		for(int p = 0; p < m; p += 4) {
+			__m128 wr = _mm_loadu_ps(twr+p), wi = _mm_loadu_ps(twi+p);
+			__m128 ar = _mm_loadu_ps(xr+p), ai = _mm_loadu_ps(xi+p);
+			__m128 br = _mm_loadu_ps(xr+p+m), bi = _mm_loadu_ps(xi+p+m);
+			__m128 sr = _mm_add_ps(ar, br), si = _mm_add_ps(ai, bi);
+			__m128 dr = _mm_sub_ps(ar, br), di = _mm_sub_ps(ai, bi);
+			__m128 tr = _mm_sub_ps(_mm_mul_ps(dr, wr), _mm_mul_ps(di, wi));
+			__m128 ti = _mm_add_ps(_mm_mul_ps(dr, wi), _mm_mul_ps(di, wr));
+			_mm_storeu_ps(yr+2*p, _mm_unpacklo_ps(sr, tr));
+			_mm_storeu_ps(yi+2*p, _mm_unpacklo_ps(si, ti));
+			_mm_storeu_ps(yr+2*p+4, _mm_unpackhi_ps(sr, tr));
+			_mm_storeu_ps(yi+2*p+4, _mm_unpackhi_ps(si, ti));
+		}
+	}
+	else fftPassSimple(n, s, twr, twi, xr, xi, yr, yi);
+}
+
+#else
+
+void fftPass(int n, int s, const float* twr, const float* twi, const float* xr, const float* xi, float* yr, float* yi) {
+	fftPassSimple(n, s, twr, twi, xr, xi, yr, yi);
+}
+
+#endif
+
+FftPlan::FftPlan(int size) {
+	if(size < 2 || (size&(size-1)) != 0) ERROR(Lav_ERROR_RANGE, "Fft sizes must be powers of 2.");
+	this->size = size;
+	half = size/2;
+	for(int n = half, s = 1; n > 1; n /= 2, s *= 2) {
+		twiddle_offsets.push_back((int)twiddle_real.size());
+		int repeat = s == 2 ? 2 : 1;
+		for(int p = 0; p < n/2; p++) {
+			double angle = -2*PI*p/n;
+			for(int r = 0; r < repeat; r++) {
+				twiddle_real.push_back((float)cos(angle));
+				twiddle_imag.push_back((float)sin(angle));
+			}
+		}
+	}
+	//Keep the pointers below valid for sizes without passes.
+	twiddle_real.push_back(0.0f);
+	twiddle_imag.push_back(0.0f);
+	for(int k = 0; k < half; k++) {
+		double angle = -2*PI*k/size;
+		split_real.push_back((float)cos(angle));
+		split_imag.push_back((float)sin(angle));
+	}
+}
+
+int FftPlan::getSize() {
+	return size;
+}
+
+int FftPlan::getBinCount() {
+	return half+1;
+}
+
+void FftPlan::complexForward(float* &real, float* &imag, float* otherReal, float* otherImag) {
+	int pass = 0;
+	for(int n = half, s = 1; n > 1; n /= 2, s *= 2, pass++) {
+		int offset = twiddle_offsets[pass];
+		fftPass(n, s, &twiddle_real[offset], &twiddle_imag[offset], real, imag, otherReal, otherImag);
+		std::swap(real, otherReal);
+		std::swap(imag, otherImag);
+	}
+}
+
+//Not a Workspace, so that this file stands alone for src/utils/fft_benchmark.
+thread_local std::vector<float> fft_workspace;
+
+float* getFftWorkspace(int size) {
+	if((int)fft_workspace.size() < size) fft_workspace.resize(size);
+	return &fft_workspace[0];
+}
+
+void FftPlan::forward(const float* input, float* real, float* imag) {
+	float* work = getFftWorkspace(4*half);
+	float* zr = work, *zi = work+half;
+	int k = 0;
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	for(; k+4 <= half; k += 4) {
+		__m128 a = _mm_loadu_ps(input+2*k), b = _mm_loadu_ps(input+2*k+4);
+		_mm_storeu_ps(zr+k, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(zi+k, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+	#endif
+	for(; k < half; k++) {
+		zr[k] = input[2*k];
+		zi[k] = input[2*k+1];
+	}
+	complexForward(zr, zi, work+2*half, work+3*half);
+	//Z[k] is E[k]+iO[k] for the spectra of the even and odd samples, and X[k] = E[k]+W^k O[k].
+	real[0] = zr[0]+zi[0];
+	imag[0] = 0.0f;
+	real[half] = zr[0]-zi[0];
+	imag[half] = 0.0f;
+	k = 1;
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	__m128 point5 = _mm_set1_ps(0.5f);
+	for(; k+4 <= half; k += 4) {
+		__m128 ar = _mm_loadu_ps(zr+k), ai = _mm_loadu_ps(zi+k);
+		//Z[half-k] for the same four k, reversed.
+		__m128 br = _mm_shuffle_ps(_mm_loadu_ps(zr+half-k-3), _mm_loadu_ps(zr+half-k-3), _MM_SHUFFLE(0, 1, 2, 3));
+		__m128 bi = _mm_shuffle_ps(_mm_loadu_ps(zi+half-k-3), _mm_loadu_ps(zi+half-k-3), _MM_SHUFFLE(0, 1, 2, 3));
+		__m128 er = _mm_mul_ps(_mm_add_ps(ar, br), point5), ei = _mm_mul_ps(_mm_sub_ps(ai, bi), point5);
+		__m128 or_ = _mm_mul_ps(_mm_add_ps(ai, bi), point5), oi = _mm_mul_ps(_mm_sub_ps(br, ar), point5);
+		__m128 wr = _mm_loadu_ps(&split_real[k]), wi = _mm_loadu_ps(&split_imag[k]);
+		_mm_storeu_ps(real+k, _mm_add_ps(er, _mm_sub_ps(_mm_mul_ps(wr, or_), _mm_mul_ps(wi, oi))));
+		_mm_storeu_ps(imag+k, _mm_add_ps(ei, _mm_add_ps(_mm_mul_ps(wr, oi), _mm_mul_ps(wi, or_))));
+	}
+	#endif
+	for(; k < half; k++) {
+		float ar = zr[k], ai = zi[k], br = zr[half-k], bi = zi[half-k];
+		float er = (ar+br)*0.5f, ei = (ai-bi)*0.5f;
+		float or_ = (ai+bi)*0.5f, oi = (br-ar)*0.5f;
+		float wr = split_real[k], wi = split_imag[k];
+		real[k] = er+wr*or_-wi*oi;
+		imag[k] = ei+wr*oi+wi*or_;
+	}
+}
+
+void FftPlan::inverse(const float* real, const float* imag, float* output) {
+	float* work = getFftWorkspace(4*half);
+	float* zr = work, *zi = work+half;
+	//Rebuild Z = E+iO, doubled; the inverse is then the forward transform with real and imaginary parts swapped.
+	int k = 0;
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	for(; k+4 <= half; k += 4) {
+		__m128 ar = _mm_loadu_ps(real+k), ai = _mm_loadu_ps(imag+k);
+		__m128 br = _mm_shuffle_ps(_mm_loadu_ps(real+half-k-3), _mm_loadu_ps(real+half-k-3), _MM_SHUFFLE(0, 1, 2, 3));
+		__m128 bi = _mm_shuffle_ps(_mm_loadu_ps(imag+half-k-3), _mm_loadu_ps(imag+half-k-3), _MM_SHUFFLE(0, 1, 2, 3));
+		__m128 er = _mm_add_ps(ar, br), ei = _mm_sub_ps(ai, bi);
+		__m128 dr = _mm_sub_ps(ar, br), di = _mm_add_ps(ai, bi);
+		__m128 wr = _mm_loadu_ps(&split_real[k]), wi = _mm_loadu_ps(&split_imag[k]);
+		__m128 or_ = _mm_add_ps(_mm_mul_ps(dr, wr), _mm_mul_ps(di, wi));
+		__m128 oi = _mm_sub_ps(_mm_mul_ps(di, wr), _mm_mul_ps(dr, wi));
+		_mm_storeu_ps(zr+k, _mm_add_ps(ei, or_));
+		_mm_storeu_ps(zi+k, _mm_sub_ps(er, oi));
+	}
+	#endif
+	for(; k < half; k++) {
+		float ar = real[k], ai = imag[k], br = real[half-k], bi = imag[half-k];
+		float er = ar+br, ei = ai-bi;
+		float dr = ar-br, di = ai+bi;
+		float wr = split_real[k], wi = split_imag[k];
+		float or_ = dr*wr+di*wi, oi = di*wr-dr*wi;
+		//Stored swapped: zr holds the imaginary part of E+iO.
+		zr[k] = ei+or_;
+		zi[k] = er-oi;
+	}
+	complexForward(zr, zi, work+2*half, work+3*half);
+	//Swapped back: zi is the real part (the even samples), zr the imaginary part (the odd ones).
+	k = 0;
+	#if defined(LIBAUDIOVERSE_USE_SSE2)
+	for(; k+4 <= half; k += 4) {
+		__m128 even = _mm_loadu_ps(zi+k), odd = _mm_loadu_ps(zr+k);
+		_mm_storeu_ps(output+2*k, _mm_unpacklo_ps(even, odd));
+		_mm_storeu_ps(output+2*k+4, _mm_unpackhi_ps(even, odd));
+	}
+	#endif
+	for(; k < half; k++) {
+		output[2*k] = zi[k];
+		output[2*k+1] = zr[k];
+	}
+}
+
+int fftSizeAtLeast(int n) {
+	int size = 2;
+	while(size < n) size *= 2;
+	return size;
+}
+
+std::map<int, std::shared_ptr<FftPlan>> *fft_plan_cache;
+std::mutex *fft_plan_cache_mutex;
+
+void initializeFftPlanCache() {
+	fft_plan_cache = new std::map<int, std::shared_ptr<FftPlan>>();
+	fft_plan_cache_mutex = new std::mutex();
+}
+
+void shutdownFftPlanCache() {
+	delete fft_plan_cache;
+	delete fft_plan_cache_mutex;
+}
+
+std::shared_ptr<FftPlan> getFftPlan(int size) {
+	std::lock_guard<std::mutex> guard(*fft_plan_cache_mutex);
+	auto &plan = (*fft_plan_cache)[size];
+	if(plan == nullptr) plan = std::make_shared<FftPlan>(size);
+	return plan;
+}
+
+}
\ No newline at end of file
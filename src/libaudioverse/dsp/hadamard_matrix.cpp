@@ -32,4 +32,19 @@ void hadamard(int n, float* buffer, bool shouldNormalize) {
 	}
 }
 
+void fastWalshHadamard(int n, float* buffer) {
+	//Each pass combines pairs of halves of blocks of size 2*half, which is the recursive construction in hadamard run in reverse.
+	for(int half = 1; half < n; half *= 2) {
+		for(int block = 0; block < n; block += 2*half) {
+			float* a = buffer+block;
+			float* b = a+half;
+			for(int i = 0; i < half; i++) {
+				float x = a[i], y = b[i];
+				a[i] = x+y;
+				b[i] = x-y;
+			}
+		}
+	}
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,270 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+/**Factors transfer functions into cascaded second-order sections.*/
+#include <libaudioverse/private/dspmath.hpp>
+#include <libaudioverse/private/constants.hpp>
+#include <math.h>
+#include <complex>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+namespace libaudioverse_implementation {
+
+typedef std::complex<double> cdouble;
+
+//Finds the roots of z^n+c[0]z^(n-1)+...+c[n-1] with the Aberth-Ehrlich method.
+//Multiple roots converge slowly and only to a cluster, so running out of iterations isn't failure; the caller checks the result.
+//Returns false only if the iteration blows up.
+//If deflateUnitRoots is set, roots at exactly 1 and -1 are divided out first.
+static bool polynomialRoots(std::vector<double> c, bool deflateUnitRoots, std::vector<cdouble> &roots) {
+	roots.clear();
+	//Filter designs put multiple zeros at DC and Nyquist, which this method only finds to about the nth root of machine precision.
+	//So we divide those out exactly first.
+	//This can't be done for poles: a lowpass with a low cutoff has a denominator which is legitimately tiny at 1.
+	for(double r: {1.0, -1.0}) {
+		if(deflateUnitRoots == false) break;
+		while(c.size()) {
+			double p = 1.0, scale = 1.0;
+			for(auto &i: c) {
+				p = p*r+i;
+				scale += fabs(i);
+			}
+			if(fabs(p) > 1e-10*scale) break;
+			//Synthetic division by z-r.
+			double carry = 1.0;
+			for(auto &i: c) {
+				carry = i+carry*r;
+				i = carry;
+			}
+			c.pop_back();
+			roots.push_back(r);
+		}
+	}
+	int n = (int)c.size();
+	if(n == 0) return true;
+	//Clustered roots are limited by the rounding error of evaluating the polynomial near them, so we evaluate in extended precision where the platform has it.
+	auto evaluate = [&] (cdouble z, cdouble &derivative) {
+		std::complex<long double> p = 1.0, d = 0.0, lz = z;
+		for(int i = 0; i < n; i++) {
+			d = d*lz+p;
+			p = p*lz+(long double)c[i];
+		}
+		derivative = cdouble(d);
+		return cdouble(p);
+	};
+	int deflated = (int)roots.size();
+	//Start on a circle whose radius is the geometric mean of the root magnitudes, offset so no guess is real.
+	double radius = pow(std::max(fabs(c[n-1]), 1e-12), 1.0/n);
+	for(int i = 0; i < n; i++) roots.push_back(std::polar(radius, 2*PI*i/n+0.4));
+	for(int iteration = 0; iteration < 500; iteration++) {
+		bool converged = true;
+		for(int i = deflated; i < n+deflated; i++) {
+			cdouble derivative;
+			cdouble p = evaluate(roots[i], derivative);
+			if(p == 0.0) continue;
+			cdouble ratio = p/derivative;
+			cdouble repulsion = 0.0;
+			for(int j = deflated; j < n+deflated; j++) if(j != i) repulsion += 1.0/(roots[i]-roots[j]);
+			cdouble step = ratio/(1.0-ratio*repulsion);
+			if(!std::isfinite(step.real()) || !std::isfinite(step.imag())) return false;
+			roots[i] -= step;
+			if(std::abs(step) > 1e-14*(1.0+std::abs(roots[i]))) converged = false;
+		}
+		if(converged) break;
+	}
+	return true;
+}
+
+//A factor of the numerator or denominator, as a polynomial in z^-1 of degree 1 or 2 with a leading 1 (or 0 for delays).
+struct SectionFactor {
+	double coefficients[3] = {1.0, 0.0, 0.0};
+	int degree = 0;
+	//The roots, for pairing poles with zeros.  Delays have none.
+	std::vector<cdouble> roots;
+};
+
+static void multiplyFactors(SectionFactor &into, const SectionFactor &other) {
+	double result[3] = {0.0, 0.0, 0.0};
+	for(int i = 0; i <= into.degree; i++) {
+		for(int j = 0; j <= other.degree; j++) result[i+j] += into.coefficients[i]*other.coefficients[j];
+	}
+	std::copy(result, result+3, into.coefficients);
+	into.degree += other.degree;
+	into.roots.insert(into.roots.end(), other.roots.begin(), other.roots.end());
+}
+
+//Turns roots into factors of degree 2, except possibly for one of degree 1.
+//Returns false if the complex roots don't come in pairs.
+static bool rootsToFactors(std::vector<cdouble> roots, std::vector<SectionFactor> &factors) {
+	std::vector<SectionFactor> real;
+	while(roots.size()) {
+		cdouble r = roots.back();
+		roots.pop_back();
+		SectionFactor f;
+		if(fabs(r.imag()) <= 1e-9*std::max(1.0, std::abs(r))) {
+			f.degree = 1;
+			f.coefficients[1] = -r.real();
+			f.roots.push_back(r.real());
+			real.push_back(f);
+			continue;
+		}
+		//Find the partner.  Multiple roots make this inexact, so we average the pair into a true conjugate pair.
+		//A bad pairing shows up when the caller checks the sections against the original polynomials.
+		int best = -1;
+		double bestDistance = std::numeric_limits<double>::infinity();
+		for(int i = 0; i < (int)roots.size(); i++) {
+			double d = std::abs(roots[i]-std::conj(r));
+			if(d < bestDistance) {
+				best = i;
+				bestDistance = d;
+			}
+		}
+		if(best == -1) return false;
+		cdouble averaged = (r+std::conj(roots[best]))/2.0;
+		roots.erase(roots.begin()+best);
+		f.degree = 2;
+		f.coefficients[1] = -2.0*averaged.real();
+		f.coefficients[2] = std::norm(averaged);
+		f.roots.push_back(averaged);
+		f.roots.push_back(std::conj(averaged));
+		factors.push_back(f);
+	}
+	//Real roots are paired in order of magnitude, which keeps similar roots in the same section.
+	std::sort(real.begin(), real.end(), [] (const SectionFactor &a, const SectionFactor &b) {
+		return fabs(a.roots[0].real()) < fabs(b.roots[0].real());
+	});
+	for(int i = 0; i < (int)real.size(); i += 2) {
+		if(i+1 < (int)real.size()) multiplyFactors(real[i], real[i+1]);
+		factors.push_back(real[i]);
+	}
+	return true;
+}
+
+//Strips leading and trailing zeros and divides by the leading coefficient.
+//leadingZeros is how many powers of z^-1 were factored out.  Returns the leading coefficient, or 0 for the zero polynomial.
+static double normalizePolynomial(int length, const double* p, int &leadingZeros, std::vector<double> &monic) {
+	int first = 0, last = length-1;
+	while(first < length && p[first] == 0.0) first++;
+	if(first == length) return 0.0;
+	while(p[last] == 0.0) last--;
+	leadingZeros = first;
+	monic.clear();
+	for(int i = first+1; i <= last; i++) monic.push_back(p[i]/p[first]);
+	return p[first];
+}
+
+static double factorDistance(const SectionFactor &a, const SectionFactor &b) {
+	double d = std::numeric_limits<double>::infinity();
+	for(auto &i: a.roots) for(auto &j: b.roots) d = std::min(d, std::abs(i-j));
+	return d;
+}
+
+static double distanceToUnitCircle(const SectionFactor &f) {
+	double d = std::numeric_limits<double>::infinity();
+	for(auto &r: f.roots) d = std::min(d, fabs(1.0-std::abs(r)));
+	return d;
+}
+
+//Multiplies the numerators or denominators of the sections back out, to check against the original.
+static std::vector<double> expandSections(const std::vector<double> &sections, bool denominators) {
+	std::vector<double> result(1, 1.0);
+	for(int s = 0; s < (int)sections.size()/5; s++) {
+		const double* c = &sections[s*5];
+		double f[3] = {c[0], c[1], c[2]};
+		if(denominators) {
+			f[0] = 1.0;
+			f[1] = c[3];
+			f[2] = c[4];
+		}
+		std::vector<double> next(result.size()+2, 0.0);
+		for(int i = 0; i < (int)result.size(); i++) for(int j = 0; j < 3; j++) next[i+j] += result[i]*f[j];
+		result = next;
+	}
+	return result;
+}
+
+static bool matchesPolynomial(const std::vector<double> &expanded, int length, const double* p, double scale) {
+	double largest = 0.0, error = 0.0;
+	for(int i = 0; i < length; i++) largest = std::max(largest, fabs(p[i]*scale));
+	for(int i = 0; i < (int)std::max<size_t>(expanded.size(), length); i++) {
+		double expected = i < length ? p[i]*scale : 0.0;
+		double got = i < (int)expanded.size() ? expanded[i] : 0.0;
+		error = std::max(error, fabs(expected-got));
+	}
+	return error <= 1e-6*largest;
+}
+
+bool factorSecondOrderSections(int numeratorLength, const double* numerator, int denominatorLength, const double* denominator, std::vector<double> &sections) {
+	if(numeratorLength < 1 || denominatorLength < 1 || denominator[0] == 0.0) return false;
+	std::vector<double> result;
+	int numeratorDelay = 0, unused = 0;
+	std::vector<double> monicNumerator, monicDenominator;
+	double numeratorLead = normalizePolynomial(numeratorLength, numerator, numeratorDelay, monicNumerator);
+	normalizePolynomial(denominatorLength, denominator, unused, monicDenominator);
+	if(numeratorLead == 0.0) {
+		//The zero filter.
+		sections.assign(5, 0.0);
+		return true;
+	}
+	std::vector<cdouble> zeros, poles;
+	if(polynomialRoots(monicNumerator, true, zeros) == false || polynomialRoots(monicDenominator, false, poles) == false) return false;
+	std::vector<SectionFactor> zeroFactors, poleFactors;
+	if(rootsToFactors(zeros, zeroFactors) == false || rootsToFactors(poles, poleFactors) == false) return false;
+	//Delays are factors of z^-1, which we fold into the lowest-degree zero factors.
+	for(int i = 0; i < numeratorDelay; i++) {
+		SectionFactor delay;
+		delay.degree = 1;
+		delay.coefficients[0] = 0.0;
+		delay.coefficients[1] = 1.0;
+		auto smallest = std::min_element(zeroFactors.begin(), zeroFactors.end(), [] (const SectionFactor &a, const SectionFactor &b) {
+			return a.degree < b.degree;
+		});
+		if(smallest != zeroFactors.end() && smallest->degree < 2) multiplyFactors(*smallest, delay);
+		else zeroFactors.push_back(delay);
+	}
+	//Poles closest to the unit circle have the most gain, so they get the nearest zeros to tame it and go last in the cascade.
+	std::sort(poleFactors.begin(), poleFactors.end(), [] (const SectionFactor &a, const SectionFactor &b) {
+		return distanceToUnitCircle(a) > distanceToUnitCircle(b);
+	});
+	std::vector<std::pair<SectionFactor, SectionFactor>> pairs;
+	for(int i = (int)poleFactors.size()-1; i >= 0; i--) {
+		SectionFactor zero;
+		if(zeroFactors.size()) {
+			auto nearest = std::min_element(zeroFactors.begin(), zeroFactors.end(), [&] (const SectionFactor &a, const SectionFactor &b) {
+				return factorDistance(a, poleFactors[i]) < factorDistance(b, poleFactors[i]);
+			});
+			zero = *nearest;
+			zeroFactors.erase(nearest);
+		}
+		pairs.insert(pairs.begin(), std::make_pair(zero, poleFactors[i]));
+	}
+	for(auto &z: zeroFactors) pairs.push_back(std::make_pair(z, SectionFactor()));
+	if(pairs.empty()) pairs.push_back(std::make_pair(SectionFactor(), SectionFactor()));
+	for(auto &p: pairs) {
+		result.push_back(p.first.coefficients[0]);
+		result.push_back(p.first.coefficients[1]);
+		result.push_back(p.first.coefficients[2]);
+		result.push_back(p.second.coefficients[1]);
+		result.push_back(p.second.coefficients[2]);
+	}
+	//The overall gain goes on the first section.
+	double gain = numeratorLead/denominator[0];
+	for(int i = 0; i < 3; i++) result[i] *= gain;
+	if(matchesPolynomial(expandSections(result, false), numeratorLength, numerator, 1.0/denominator[0]) == false) return false;
+	if(matchesPolynomial(expandSections(result, true), denominatorLength, denominator, 1.0/denominator[0]) == false) return false;
+	//Ill-conditioned denominators can match to within rounding with roots that are badly wrong.
+	//If that made a section unstable, the caller is better off with the direct form, which is at least the filter it asked for.
+	for(int i = 0; i < (int)result.size(); i += 5) {
+		double a1 = result[i+3], a2 = result[i+4];
+		if(fabs(a2) >= 1.0 || fabs(a1) >= 1.0+a2) return false;
+	}
+	sections = result;
+	return true;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+/**Recognizes feedback matrices which can be applied faster than a full matrix-vector product.*/
+#include <libaudioverse/private/dspmath.hpp>
+#include <math.h>
+#include <algorithm>
+
+namespace libaudioverse_implementation {
+
+//Entries are allowed to differ from the structure by this much, relative to the largest entry.
+//The matrices from hadamard and householder are only accurate to single precision.
+const float STRUCTURE_TOLERANCE = 1e-5f;
+
+template<typename StructureT>
+static bool factorScaled(int n, const float* matrix, StructureT structure, float* rowGains, float* columnGains) {
+	float largest = 0.0f;
+	for(int i = 0; i < n*n; i++) largest = std::max(largest, fabsf(matrix[i]));
+	if(largest == 0.0f) {
+		std::fill(rowGains, rowGains+n, 0.0f);
+		std::fill(columnGains, columnGains+n, 1.0f);
+		return true;
+	}
+	//Gains are only determined up to a common factor, so fix the first column's at 1.
+	//Then the first column gives the row gains, and the row with the largest gain gives the rest of the column gains.
+	int best = 0;
+	for(int i = 0; i < n; i++) {
+		if(structure(i, 0) == 0.0f) return false;
+		rowGains[i] = matrix[i*n]/structure(i, 0);
+		if(fabsf(rowGains[i]) > fabsf(rowGains[best])) best = i;
+	}
+	if(rowGains[best] == 0.0f) return false;
+	for(int j = 0; j < n; j++) {
+		if(structure(best, j) == 0.0f) return false;
+		columnGains[j] = matrix[best*n+j]/(rowGains[best]*structure(best, j));
+	}
+	for(int i = 0; i < n; i++) {
+		for(int j = 0; j < n; j++) {
+			if(fabsf(matrix[i*n+j]-rowGains[i]*structure(i, j)*columnGains[j]) > STRUCTURE_TOLERANCE*largest) return false;
+		}
+	}
+	return true;
+}
+
+//1 if x has an odd number of set bits.  The matrix made by hadamard is -1 at (i, j) exactly when i&j does.
+static int bitParity(unsigned int x) {
+	int parity = 0;
+	while(x) {
+		parity ^= 1;
+		x &= x-1;
+	}
+	return parity;
+}
+
+bool factorScaledHadamard(int n, const float* matrix, float* rowGains, float* columnGains) {
+	if(n < 1 || (n & (n-1))) return false;
+	return factorScaled(n, matrix, [] (int i, int j) {
+		return bitParity(i & j) ? -1.0f : 1.0f;
+	}, rowGains, columnGains);
+}
+
+bool factorScaledHouseholder(int n, const float* matrix, float* rowGains, float* columnGains) {
+	//For n of 2 the diagonal is 0, and the general path is just as fast anyway.
+	if(n < 3) return false;
+	float offDiagonal = -2.0f/n;
+	return factorScaled(n, matrix, [=] (int i, int j) {
+		return i == j ? 1.0f+offDiagonal : offDiagonal;
+	}, rowGains, columnGains);
+}
+
+}
\ No newline at end of file
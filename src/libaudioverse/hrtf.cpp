@@ -19,6 +19,10 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/data.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/utf8.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/private/server.hpp>
+#include <libaudioverse/private/logging.hpp>
+#include <libaudioverse/implementations/convolvers.hpp>
 #include <powercores/thread_local_variable.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/filesystem.hpp>
@@ -32,6 +36,8 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <tuple>
 #include <ios>
 #include <system_error>
+#include <vector>
+#include <complex>
 
 namespace libaudioverse_implementation {
 
@@ -79,8 +85,10 @@ HrtfData::~HrtfData() {
 		//The staticResamplerKernel allocates with new[], not allocArray.
 		for(int j = 0; j < azimuth_counts[i]; j++) delete[] hrirs[i][j];
 		delete[] hrirs[i];
+		if(delays) delete[] delays[i];
 	}
 	delete[] hrirs;
+	if(delays) delete[] delays;
 	delete[] azimuth_counts;
 }
 
@@ -179,11 +187,121 @@ void HrtfData::loadFromBuffer(unsigned int length, char* buffer, unsigned int fo
 	freeArray(tempBuffer);
 }
 
-//a complete HRTF for stereo is two calls to this function.
-//some final preparation is done afterwords.
+//Where the hrir starts: the first crossing of a fraction of its peak, interpolated between samples.
+//The leading silence is the delay to the ear; where in it the sound starts doesn't change its magnitude response.
+float findOnset(int length, float* hrir) {
+	const float onsetFraction = 0.2f;
+	float peak = 0.0f;
+	for(int i = 0; i < length; i++) peak = std::max(peak, fabsf(hrir[i]));
+	if(peak == 0.0f) return 0.0f;
+	float threshold = peak*onsetFraction;
+	for(int i = 0; i < length; i++) {
+		float magnitude = fabsf(hrir[i]);
+		if(magnitude < threshold) continue;
+		if(i == 0) return 0.0f;
+		float previous = fabsf(hrir[i-1]);
+		return i-1+(threshold-previous)/(magnitude-previous);
+	}
+	return 0.0f;
+}
+
+//The minimum phase filter with the same magnitude response, by folding the real cepstrum.
+//The fft is made several times longer than the hrir, so that the cepstrum doesn't alias.
+void minimumPhase(int length, float* hrir, int outputLength, float* output) {
+	int size = fftSizeAtLeast(8*std::max(length, outputLength));
+	auto plan = getFftPlan(size);
+	int bins = plan->getBinCount();
+	std::vector<float> samples(size, 0.0f), real(bins), imag(bins);
+	std::copy(hrir, hrir+length, samples.begin());
+	plan->forward(&samples[0], &real[0], &imag[0]);
+	float peak = 0.0f;
+	for(int i = 0; i < bins; i++) peak = std::max(peak, std::hypot(real[i], imag[i]));
+	//Keep the log finite at nulls; 120 db down is far below anything audible.
+	float floor = std::max(peak*1e-6f, 1e-30f);
+	for(int i = 0; i < bins; i++) {
+		real[i] = logf(std::max(std::hypot(real[i], imag[i]), floor));
+		imag[i] = 0.0f;
+	}
+	plan->inverse(&real[0], &imag[0], &samples[0]);
+	//The cepstrum is even; the minimum phase one is causal, with the negative half folded onto the positive.
+	//The inverse isn't normalized, so do that here too.
+	float scale = 1.0f/size;
+	samples[0] *= scale;
+	for(int i = 1; i < size/2; i++) samples[i] *= 2.0f*scale;
+	samples[size/2] *= scale;
+	std::fill(samples.begin()+size/2+1, samples.end(), 0.0f);
+	plan->forward(&samples[0], &real[0], &imag[0]);
+	for(int i = 0; i < bins; i++) {
+		auto v = std::exp(std::complex<float>(real[i], imag[i]));
+		real[i] = v.real();
+		imag[i] = v.imag();
+	}
+	plan->inverse(&real[0], &imag[0], &samples[0]);
+	for(int i = 0; i < outputLength; i++) output[i] = samples[i]*scale;
+}
+
+void HrtfData::makeMinimumPhase(int length) {
+	delays = new float*[elev_count];
+	float earliest = INFINITY;
+	for(int elev = 0; elev < elev_count; elev++) {
+		delays[elev] = new float[azimuth_counts[elev]];
+		for(int azimuth = 0; azimuth < azimuth_counts[elev]; azimuth++) {
+			float* hrir = hrirs[elev][azimuth];
+			delays[elev][azimuth] = findOnset(hrir_length, hrir);
+			earliest = std::min(earliest, delays[elev][azimuth]);
+			//Allocated with new[] to match staticResamplerKernel.
+			float* shortened = new float[length];
+			minimumPhase(hrir_length, hrir, length, shortened);
+			delete[] hrir;
+			hrirs[elev][azimuth] = shortened;
+		}
+	}
+	//Delay common to every direction is latency, not position.
+	max_delay = 0.0f;
+	for(int elev = 0; elev < elev_count; elev++) {
+		for(int azimuth = 0; azimuth < azimuth_counts[elev]; azimuth++) {
+			delays[elev][azimuth] -= earliest;
+			max_delay = std::max(max_delay, delays[elev][azimuth]);
+		}
+	}
+	hrir_length = length;
+}
+
+bool HrtfData::hasDelays() {
+	return delays != nullptr;
+}
+
+float HrtfData::getMaxDelay() {
+	return max_delay;
+}
+
+float HrtfData::computeDelayMono(float elevation, float azimuth) {
+	auto weights = computeWeights(elevation, azimuth);
+	float delay = 0.0f;
+	for(int i = 0; i < 2; i++) {
+		for(int j = 0; j < 2; j++) delay += (float)(weights.elevation_weights[i]*weights.azimuth_weights[i][j])*delays[weights.elevations[i]][weights.azimuths[i][j]];
+	}
+	return delay;
+}
+
+void HrtfData::computeDelaysStereo(float elevation, float azimuth, float &left, float &right) {
+	if(hasGrid()) {
+		right = grid_delays[gridIndex(elevation, azimuth)];
+		left = grid_delays[gridIndex(elevation, 360-azimuth)];
+		return;
+	}
+	//Exactly as computeCoefficientsStereo.
+	azimuth = ringmodf(azimuth, 360.0f);
+	right = computeDelayMono(elevation, azimuth);
+	azimuth = ringmodf(360-azimuth, 360.0f);
+	left = computeDelayMono(elevation, azimuth);
+}
+
+//Find the hrirs around a direction and their weights, which both the time and frequency domain use.
 //This is very complicated, thus the heavy commenting.
 //todo: can this be made simpler?
-void HrtfData::computeCoefficientsMono(float elevation, float azimuth, float* out) {
+HrirWeights HrtfData::computeWeights(float elevation, float azimuth) {
+	HrirWeights weights;
 	//clamp the elevation.
 	if(elevation < min_elevation) {elevation = (float)min_elevation;}
 	else if(elevation > max_elevation) {elevation = (float)max_elevation;}
@@ -201,23 +319,20 @@ void HrtfData::computeCoefficientsMono(float elevation, float azimuth, float* ou
 
 	//we have a truncated elevation.  We now simply take an integer division, or assume it's 0.
 	//This is an array because We need to do the vertical crossfade in this function.
-	int elevationIndex[2];
+	int* elevationIndex = weights.elevations;
 	elevationIndex[0] = degreesPerElevation ? truncatedElevation/degreesPerElevation : 0;
 	//this is relative to whatever index happens to be "0", that is it is an offset from the 0 index.  We have to offset it upwards so it's not negative.
 	int elevationIndexOffset = degreesPerElevation ? abs(min_elevation)/degreesPerElevation : 0;
 	elevationIndex[0] += elevationIndexOffset;
 	elevationIndex[1] = std::min(elevationIndex[0]+1, elev_count-1);
-	double elevationWeights[2];
+	double* elevationWeights = weights.elevation_weights;
 	float ringmoddedElevation = ringmodf(elevation, degreesPerElevation);
 	if(ringmoddedElevation < 0) ringmoddedElevation =degreesPerElevation-ringmoddedElevation;
 	if(ringmoddedElevation > degreesPerElevation) ringmoddedElevation = degreesPerElevation;
 	elevationWeights[0] = (degreesPerElevation-ringmoddedElevation)/degreesPerElevation;
 	elevationWeights[1] = ringmoddedElevation/degreesPerElevation;
 
-	memset(out, 0, sizeof(float)*hrir_length);
 	for(int i = 0; i < 2; i++) {
-		//ElevationIndex lets us get an array of azimuth coefficients.  Go ahead and pull it out now, so we can conceptually forget about all the above variables.
-		float** azimuths = hrirs[elevationIndex[i]];
 		int azimuthCount = azimuth_counts[elevationIndex[i]];
 		float degreesPerAzimuth = 360.0f/azimuthCount;
 		int azimuthIndex1, azimuthIndex2;
@@ -230,15 +345,52 @@ void HrtfData::computeCoefficientsMono(float elevation, float azimuth, float* ou
 		//now that we have some weights, we need to ringmod the azimuth indices. 360==0 in trig, but causes one of them to go past the end.
 		azimuthIndex1 = ringmodi(azimuthIndex1, azimuthCount);
 		azimuthIndex2 = ringmodi(azimuthIndex2, azimuthCount);
+		weights.azimuths[i][0] = azimuthIndex1;
+		weights.azimuths[i][1] = azimuthIndex2;
+		weights.azimuth_weights[i][0] = azimuthWeight1;
+		weights.azimuth_weights[i][1] = azimuthWeight2;
+	}
+	return weights;
+}
 
-		//this is probably the only part of this that can't go wrong, assuming the above calculations are all correct.  Interpolate between the two azimuths.
+//a complete HRTF for stereo is two calls to this function.
+//some final preparation is done afterwords.
+void HrtfData::computeCoefficientsMono(float elevation, float azimuth, float* out) {
+	auto weights = computeWeights(elevation, azimuth);
+	memset(out, 0, sizeof(float)*hrir_length);
+	for(int i = 0; i < 2; i++) {
+		//The elevation lets us get an array of azimuth coefficients.
+		float** azimuths = hrirs[weights.elevations[i]];
+		float* hrir1 = azimuths[weights.azimuths[i][0]], *hrir2 = azimuths[weights.azimuths[i][1]];
+		float azimuthWeight1 = weights.azimuth_weights[i][0], azimuthWeight2 = weights.azimuth_weights[i][1];
+		//Interpolate between the two azimuths.
 		for(int j = 0; j < hrir_length; j++) {
-			out[j] += elevationWeights[i]*(azimuthWeight1*azimuths[azimuthIndex1][j]+azimuthWeight2*azimuths[azimuthIndex2][j]);
+			out[j] += weights.elevation_weights[i]*(azimuthWeight1*hrir1[j]+azimuthWeight2*hrir2[j]);
+		}
+	}
+}
+
+void HrtfData::computeSpectraMono(float elevation, float azimuth, HrirSpectra &spectra, PartitionedResponse* out) {
+	auto weights = computeWeights(elevation, azimuth);
+	PartitionedResponse* sources[4];
+	float mixWeights[4];
+	for(int i = 0; i < 2; i++) {
+		for(int j = 0; j < 2; j++) {
+			sources[i*2+j] = spectra[weights.elevations[i]][weights.azimuths[i][j]].get();
+			mixWeights[i*2+j] = (float)(weights.elevation_weights[i]*weights.azimuth_weights[i][j]);
 		}
 	}
+	out->mix(4, sources, mixWeights);
 }
 
 void HrtfData::computeCoefficientsStereo(float elevation, float azimuth, float *left, float* right) {
+	if(hasGrid()) {
+		float* gridLeft, *gridRight;
+		getGridCoefficientsStereo(elevation, azimuth, gridLeft, gridRight);
+		std::copy(gridLeft, gridLeft+hrir_length, left);
+		std::copy(gridRight, gridRight+hrir_length, right);
+		return;
+	}
 	//wrap azimuth to be > 0 and < 360.
 	azimuth = ringmodf(azimuth, 360.0f);
 	//the hrtf datasets are right ear coefficients.  Consequently, the right ear requires no changes.
@@ -248,6 +400,71 @@ void HrtfData::computeCoefficientsStereo(float elevation, float azimuth, float *
 	computeCoefficientsMono(elevation, azimuth, left);
 }
 
+void HrtfData::computeSpectraStereo(float elevation, float azimuth, HrirSpectra &spectra, PartitionedResponse* left, PartitionedResponse* right) {
+	//Exactly as computeCoefficientsStereo.
+	azimuth = ringmodf(azimuth, 360.0f);
+	computeSpectraMono(elevation, azimuth, spectra, right);
+	azimuth = ringmodf(360-azimuth, 360.0f);
+	computeSpectraMono(elevation, azimuth, spectra, left);
+}
+
+std::shared_ptr<HrirSpectra> HrtfData::getSpectra(int blockSize) {
+	std::lock_guard<std::mutex> guard(spectra_mutex);
+	auto &s = spectra[blockSize];
+	if(s) return s;
+	s = std::make_shared<HrirSpectra>(elev_count);
+	for(int elev = 0; elev < elev_count; elev++) {
+		for(int azimuth = 0; azimuth < azimuth_counts[elev]; azimuth++) (*s)[elev].push_back(std::make_shared<PartitionedResponse>(blockSize, hrir_length, hrirs[elev][azimuth]));
+	}
+	return s;
+}
+
+double computeHrtfGridSize(float azimuthStep, float elevationStep, float elevationRange, int length) {
+	//The same counts buildGrid computes, but in floats so that they can't overflow.
+	double azimuths = std::max(1.0f, ceilf(360.0f/azimuthStep)), elevations = std::max(1.0f, ceilf(elevationRange/elevationStep)+1);
+	return azimuths*elevations*length*sizeof(float);
+}
+
+void HrtfData::buildGrid(float azimuthStep, float elevationStep) {
+	if(computeHrtfGridSize(azimuthStep, elevationStep, (float)(max_elevation-min_elevation), hrir_length) > HRTF_MAX_GRID_SIZE) ERROR(Lav_ERROR_RANGE, "HRTF grid would be larger than 64 MB.");
+	grid_azimuth_count = std::max(1, (int)ceilf(360.0f/azimuthStep));
+	grid_azimuth_step = 360.0f/grid_azimuth_count;
+	grid_elevation_count = std::max(1, (int)ceilf((max_elevation-min_elevation)/elevationStep)+1);
+	grid_elevation_step = grid_elevation_count > 1 ? (float)(max_elevation-min_elevation)/(grid_elevation_count-1) : 0.0f;
+	grid_coefficients.resize((std::size_t)grid_azimuth_count*grid_elevation_count*hrir_length);
+	if(hasDelays()) grid_delays.resize((std::size_t)grid_azimuth_count*grid_elevation_count);
+	for(int elev = 0; elev < grid_elevation_count; elev++) {
+		for(int azimuth = 0; azimuth < grid_azimuth_count; azimuth++) {
+			int index = elev*grid_azimuth_count+azimuth;
+			float e = min_elevation+elev*grid_elevation_step, a = azimuth*grid_azimuth_step;
+			computeCoefficientsMono(e, a, &grid_coefficients[(std::size_t)index*hrir_length]);
+			if(hasDelays()) grid_delays[index] = computeDelayMono(e, a);
+		}
+	}
+	logInfo("HRTF grid: %i by %i directions, %.1f MB.", grid_azimuth_count, grid_elevation_count, getGridSize()/(1024.0*1024.0));
+}
+
+bool HrtfData::hasGrid() {
+	return grid_coefficients.size() != 0;
+}
+
+int HrtfData::gridIndex(float elevation, float azimuth) {
+	int elev = 0;
+	if(grid_elevation_count > 1) elev = std::min(std::max((int)roundf((elevation-min_elevation)/grid_elevation_step), 0), grid_elevation_count-1);
+	int a = ringmodi((int)roundf(ringmodf(azimuth, 360.0f)/grid_azimuth_step), grid_azimuth_count);
+	return elev*grid_azimuth_count+a;
+}
+
+void HrtfData::getGridCoefficientsStereo(float elevation, float azimuth, float* &left, float* &right) {
+	//The left ear is the right reflected about 0 degrees, as in computeCoefficientsStereo.
+	right = &grid_coefficients[(std::size_t)gridIndex(elevation, azimuth)*hrir_length];
+	left = &grid_coefficients[(std::size_t)gridIndex(elevation, 360-azimuth)*hrir_length];
+}
+
+std::size_t HrtfData::getGridSize() {
+	return sizeof(float)*(grid_coefficients.size()+grid_delays.size());
+}
+
 //Create and free buffers.
 //These are used by the thread locals.
 
@@ -285,14 +502,19 @@ bool operator>(const HrtfId& a, const HrtfId& b) {
 	return memcmp(a.identity, b.identity, 16) == 1;
 }
 
-std::map<int, std::shared_ptr<HrtfData>> *default_hrtf_cache;
-//Tuple of (forSr, HrtfId).
-std::map<std::tuple<int, HrtfId>, std::shared_ptr<HrtfData>> *file_hrtf_cache;
+bool operator<(const HrtfOptions &a, const HrtfOptions &b) {
+	return std::make_tuple(a.minimum_phase_length, a.grid_azimuth_step, a.grid_elevation_step) < std::make_tuple(b.minimum_phase_length, b.grid_azimuth_step, b.grid_elevation_step);
+}
+
+//Tuple of (forSr, options).
+std::map<std::tuple<int, HrtfOptions>, std::shared_ptr<HrtfData>> *default_hrtf_cache;
+//Tuple of (forSr, options, HrtfId).
+std::map<std::tuple<int, HrtfOptions, HrtfId>, std::shared_ptr<HrtfData>> *file_hrtf_cache;
 std::mutex *hrtf_cache_mutex;
 
 void initializeHrtfCaches() {
-	default_hrtf_cache = new std::map<int, std::shared_ptr<HrtfData>>();
-	file_hrtf_cache = new std::map<std::tuple<int, HrtfId>, std::shared_ptr<HrtfData>>();
+	default_hrtf_cache = new std::map<std::tuple<int, HrtfOptions>, std::shared_ptr<HrtfData>>();
+	file_hrtf_cache = new std::map<std::tuple<int, HrtfOptions, HrtfId>, std::shared_ptr<HrtfData>>();
 	hrtf_cache_mutex = new std::mutex();
 }
 
@@ -302,13 +524,21 @@ void shutdownHrtfCaches() {
 	delete file_hrtf_cache;
 }
 
-std::shared_ptr<HrtfData> createHrtfFromString(std::string path, int forSr) {
+//Everything HrtfOptions asks for, in the order it has to happen.
+void prepareHrtf(HrtfData &h, const HrtfOptions &options) {
+	if(options.minimum_phase_length) h.makeMinimumPhase(options.minimum_phase_length);
+	if(options.grid_azimuth_step > 0.0f && options.grid_elevation_step > 0.0f) h.buildGrid(options.grid_azimuth_step, options.grid_elevation_step);
+}
+
+std::shared_ptr<HrtfData> loadHrtf(std::string path, int forSr, const HrtfOptions &options) {
 	if(path == "default") {
 		std::lock_guard<std::mutex> guard(*hrtf_cache_mutex);
-		if(default_hrtf_cache->count(forSr)) return default_hrtf_cache->at(forSr);
+		auto key = std::make_tuple(forSr, options);
+		if(default_hrtf_cache->count(key)) return default_hrtf_cache->at(key);
 		auto h = std::make_shared<HrtfData>();
 		h->loadFromDefault(forSr);
-		(*default_hrtf_cache)[forSr] = h;
+		prepareHrtf(*h, options);
+		(*default_hrtf_cache)[key] = h;
 		return h;
 	}
 	else {
@@ -317,12 +547,35 @@ std::shared_ptr<HrtfData> createHrtfFromString(std::string path, int forSr) {
 		auto identity = HrtfId(f);
 		f.close();
 		std::lock_guard<std::mutex> guard(*hrtf_cache_mutex);
-		if(file_hrtf_cache->count(std::make_tuple(forSr, identity))) return file_hrtf_cache->at(std::make_tuple(forSr, identity));
+		auto key = std::make_tuple(forSr, options, identity);
+		if(file_hrtf_cache->count(key)) return file_hrtf_cache->at(key);
 		auto h = std::make_shared<HrtfData>();
 		h->loadFromFile(path, forSr);
-		(*file_hrtf_cache)[std::make_tuple(forSr, identity)] = h;
+		prepareHrtf(*h, options);
+		(*file_hrtf_cache)[key] = h;
 		return h;
 	}
 }
 
+std::shared_ptr<HrtfData> createHrtfFromString(std::string path, int forSr, const HrtfOptions &options, int blockSize) {
+	auto h = loadHrtf(path, forSr, options);
+	//HrtfPanner makes the same choice, but shouldn't be the one to transform every hrir.  getSpectra only does it once per block size.
+	if(blockSize && chooseConvolutionEngine(blockSize, h->getLength()) != ConvolutionEngine::DIRECT) h->getSpectra(blockSize);
+	return h;
+}
+
+std::shared_ptr<HrtfData> createHrtfForServer(std::string path, std::shared_ptr<Server> server) {
+	HrtfOptions options;
+	int sr, blockSize;
+	{
+		LOCK(*server);
+		options.minimum_phase_length = server->getMinimumPhaseHrtfLength();
+		server->getHrtfGrid(options.grid_azimuth_step, options.grid_elevation_step);
+		sr = (int)server->getSr();
+		blockSize = (int)server->getBlockSize();
+	}
+	//Loading, the grid and the spectra can take a while, so they happen without the server locked.
+	return createHrtfFromString(path, sr, options, blockSize);
+}
+
 }
\ No newline at end of file
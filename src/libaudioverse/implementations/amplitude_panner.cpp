@@ -21,22 +21,19 @@ sr(_sr), block_size(_block_size) {
 
 void AmplitudePanner::clearMap() {
 	channels.clear();
+	map_changed = true;
 }
 
 void AmplitudePanner::addEntry(float angle, int channel) {
 	channels.emplace_back(ringmodf(angle, 360.0f), channel);
 	std::sort(channels.begin(), channels.end(),
 	[](AmplitudePannerEntry &a, AmplitudePannerEntry& b) {return a.angle < b.angle;});
+	map_changed = true;
 }
 
-void AmplitudePanner::pan(float* input, float** outputs) {
-	//TODO: move all this logic into something that's only called when needed.
-	//the two degenerates: 0 and 1 channels.
-	if(input == nullptr || outputs == nullptr || channels.size() == 0) return;
-	if(channels.size() == 1) {
-		std::copy(input, input+block_size, outputs[channels[0].channel]);
-		return;
-	}
+void AmplitudePanner::computeGains() {
+	target_gains.assign(channels.size(), 0.0f);
+	gains_azimuth = azimuth;
 	//We need a local copy.
 	float angle = azimuth;
 	angle = ringmodf(angle, 360.0f);
@@ -56,8 +53,6 @@ void AmplitudePanner::pan(float* input, float** outputs) {
 	else {
 		left = right == 0 ? channels.size()-1 : right-1;
 	}
-	int channel1 = channels[left].channel;
-	int channel2 = channels[right].channel;
 	//two cases: we wrapped or didn't.
 	float angle1, angle2, angleSum;
 	if(right == 0) { //left is all the way around, special handling is needed.
@@ -75,10 +70,29 @@ void AmplitudePanner::pan(float* input, float** outputs) {
 		angle2 = fabs(channels[right].angle-angle);
 	}
 	angleSum = angle1+angle2;
-	float weight2 = angle1/angleSum;
-	float weight1 = angle2/angleSum;
-	scalarMultiplicationKernel(block_size, weight1, input, outputs[channel1]);
-	scalarMultiplicationKernel(block_size, weight2, input, outputs[channel2]);
+	target_gains[right] = angle1/angleSum;
+	target_gains[left] = angle2/angleSum;
+}
+
+void AmplitudePanner::pan(float* input, float** outputs) {
+	//the two degenerates: 0 and 1 channels.
+	if(input == nullptr || outputs == nullptr || channels.size() == 0) return;
+	if(channels.size() == 1) {
+		std::copy(input, input+block_size, outputs[channels[0].channel]);
+		return;
+	}
+	//Sources set the azimuth every block, but it usually hasn't moved.
+	if(map_changed || azimuth != gains_azimuth) computeGains();
+	if(map_changed) {
+		gains = target_gains;
+		map_changed = false;
+	}
+	for(int i = 0; i < (int)channels.size(); i++) {
+		float* output = outputs[channels[i].channel];
+		if(gains[i] != target_gains[i]) rampMultiplicationKernel(block_size, gains[i], (target_gains[i]-gains[i])/block_size, input, output);
+		else if(gains[i] != 0.0f) scalarMultiplicationKernel(block_size, gains[i], input, output);
+		gains[i] = target_gains[i];
+	}
 }
 
 void AmplitudePanner::readMap(int entries, float* map) {
@@ -0,0 +1,163 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+/**Chooses between the convolvers by estimating what a block costs with each.
+Direct convolution costs a multiply-add per sample per tap.
+Sparse convolution costs the same, but only for the nonzero taps, and in a loop that vectorizes better.
+An fft convolver costs a forward and inverse fft, plus a complex multiply-add per bin per partition.
+The constants are measured rather than guessed, because the crossover points move a lot between machines and SIMD levels.*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/implementations/convolvers.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <math.h>
+
+namespace libaudioverse_implementation {
+
+//fft sizes are measured from 2^CONVOLUTION_COST_MIN_FFT_POWER to 2^CONVOLUTION_COST_MAX_FFT_POWER; bigger ones are extrapolated as n log n.
+const int CONVOLUTION_COST_MIN_FFT_POWER = 5;
+const int CONVOLUTION_COST_MAX_FFT_POWER = 15;
+
+std::once_flag convolution_costs_flag;
+//Seconds per sample per tap.
+double direct_cost;
+//Seconds per sample per sparse tap.
+double sparse_cost;
+//Seconds per bin.
+double complex_multiply_cost;
+//Seconds for a forward and inverse fft of each measured size.
+double fft_costs[CONVOLUTION_COST_MAX_FFT_POWER+1];
+
+//The fastest of a few runs, which is the one least disturbed by everything else on the machine.
+double measure(std::function<void(void)> what, int iterations) {
+	double best = INFINITY;
+	for(int run = 0; run < 5; run++) {
+		auto start = std::chrono::steady_clock::now();
+		for(int i = 0; i < iterations; i++) what();
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double>(end-start).count()/iterations);
+	}
+	return best;
+}
+
+void measureConvolutionCosts() {
+	const int length = 1024, taps = 128;
+	std::vector<float> input(length+taps), output(length), response(taps, 0.5f);
+	direct_cost = measure([&] () {
+		convolutionKernel(&input[0], length, &output[0], taps, &response[0]);
+	}, 20)/(length*taps);
+	sparse_cost = measure([&] () {
+		for(int i = 0; i < taps; i++) multiplicationAdditionKernel(length, response[i], &input[i], &output[0], &output[0]);
+	}, 20)/(length*taps);
+	const int bins = 1025;
+	std::vector<float> ar(bins, 0.5f), ai(bins, 0.5f), br(bins, 0.5f), bi(bins, 0.5f), destr(bins), desti(bins);
+	complex_multiply_cost = measure([&] () {
+		complexMultiplicationAdditionKernel(bins, &ar[0], &ai[0], &br[0], &bi[0], &destr[0], &desti[0]);
+	}, 200)/bins;
+	for(int power = CONVOLUTION_COST_MIN_FFT_POWER; power <= CONVOLUTION_COST_MAX_FFT_POWER; power++) {
+		int size = 1<<power;
+		auto plan = getFftPlan(size);
+		std::vector<float> samples(size, 0.5f), real(plan->getBinCount()), imag(plan->getBinCount());
+		fft_costs[power] = measure([&] () {
+			plan->forward(&samples[0], &real[0], &imag[0]);
+			plan->inverse(&real[0], &imag[0], &samples[0]);
+		}, std::max(2, (1<<16)/size));
+	}
+}
+
+void calibrateConvolutionCosts() {
+	std::call_once(convolution_costs_flag, measureConvolutionCosts);
+}
+
+double fftCost(int size) {
+	int power = 0;
+	while((1<<power) < size) power++;
+	power = std::max(power, CONVOLUTION_COST_MIN_FFT_POWER);
+	if(power <= CONVOLUTION_COST_MAX_FFT_POWER) return fft_costs[power];
+	double largest = (double)(1<<CONVOLUTION_COST_MAX_FFT_POWER);
+	return fft_costs[CONVOLUTION_COST_MAX_FFT_POWER]*(size*log2((double)size))/(largest*CONVOLUTION_COST_MAX_FFT_POWER);
+}
+
+ConvolutionEngine chooseConvolutionEngine(int blockSize, int responseLength, int tapCount) {
+	double direct = direct_cost*blockSize*responseLength;
+	int fftSize = fftSizeAtLeast(blockSize+responseLength);
+	double fft = fftCost(fftSize)+complex_multiply_cost*(fftSize/2+1);
+	int partitionedSize = fftSizeAtLeast(2*blockSize), partitions = (responseLength+blockSize-1)/blockSize;
+	double partitioned = fftCost(partitionedSize)+complex_multiply_cost*(partitionedSize/2+1)*partitions;
+	if(tapCount >= 0 && sparse_cost*blockSize*tapCount < std::min({direct, fft, partitioned})) return ConvolutionEngine::SPARSE;
+	if(direct <= fft && direct <= partitioned) return ConvolutionEngine::DIRECT;
+	return fft < partitioned ? ConvolutionEngine::FFT : ConvolutionEngine::PARTITIONED;
+}
+
+AutomaticConvolver::AutomaticConvolver(int blockSize): block_size(blockSize) {
+	float defaultResponse = 1.0f;
+	setResponse(1, &defaultResponse);
+}
+
+AutomaticConvolver::~AutomaticConvolver() {
+	if(direct) delete direct;
+	if(fft) delete fft;
+	if(partitioned) delete partitioned;
+	if(sparse) delete sparse;
+}
+
+void AutomaticConvolver::setResponse(int length, float* response) {
+	//Only exact zeros are dropped, so that every engine gives the same output.
+	useEngine(chooseConvolutionEngine(block_size, length, countSparseTaps(length, response)));
+	if(direct) direct->setResponse(length, response);
+	else if(fft) fft->setResponse(length, response);
+	else if(partitioned) partitioned->setResponse(length, response);
+	else sparse->setResponse(length, response);
+}
+
+void AutomaticConvolver::setTaps(int count, int* delays, float* gains) {
+	useEngine(ConvolutionEngine::SPARSE);
+	sparse->setTaps(count, delays, gains);
+}
+
+void AutomaticConvolver::useEngine(ConvolutionEngine newEngine) {
+	bool changed = newEngine != engine || (direct == nullptr && fft == nullptr && partitioned == nullptr && sparse == nullptr);
+	engine = newEngine;
+	if(changed == false) return;
+	//Only the engine in use is kept.
+	if(direct) delete direct;
+	if(fft) delete fft;
+	if(partitioned) delete partitioned;
+	if(sparse) delete sparse;
+	direct = nullptr;
+	fft = nullptr;
+	partitioned = nullptr;
+	sparse = nullptr;
+	if(engine == ConvolutionEngine::DIRECT) direct = new BlockConvolver(block_size);
+	else if(engine == ConvolutionEngine::FFT) fft = new FftConvolver(block_size);
+	else if(engine == ConvolutionEngine::PARTITIONED) partitioned = new PartitionedConvolver(block_size);
+	else sparse = new SparseConvolver(block_size);
+}
+
+void AutomaticConvolver::convolve(float* input, float* output) {
+	if(direct) direct->convolve(input, output);
+	else if(fft) fft->convolve(input, output);
+	else if(partitioned) partitioned->convolve(input, output);
+	else sparse->convolve(input, output);
+}
+
+void AutomaticConvolver::reset() {
+	if(direct) direct->reset();
+	else if(fft) fft->reset();
+	else if(partitioned) partitioned->reset();
+	else sparse->reset();
+}
+
+ConvolutionEngine AutomaticConvolver::getEngine() {
+	return engine;
+}
+
+}
\ No newline at end of file
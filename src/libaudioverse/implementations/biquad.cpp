@@ -14,6 +14,8 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <algorithm>
 #include <functional>
 #include <math.h>
+#include <string.h>
+#include <stdint.h>
 
 namespace libaudioverse_implementation {
 
@@ -63,6 +65,93 @@ void BiquadFilter::setSlave(BiquadFilter* s) {
 	slave = s;
 }
 
+void BiquadFilter::processLanes(int count, BiquadFilter** filters, int length, float** inputs, float** outputs) {
+	double coefficients[20] = {}, history[8] = {};
+	for(int i = 0; i < count; i++) {
+		auto f = filters[i];
+		coefficients[i] = f->b0;
+		coefficients[4+i] = f->b1;
+		coefficients[8+i] = f->b2;
+		coefficients[12+i] = f->a1;
+		coefficients[16+i] = f->a2;
+		history[i] = f->h1;
+		history[4+i] = f->h2;
+	}
+	biquadLanesKernel(count, length, inputs, outputs, coefficients, history);
+	for(int i = 0; i < count; i++) {
+		filters[i]->h1 = history[i];
+		filters[i]->h2 = history[4+i];
+	}
+}
+
+void BiquadFilter::processLanesRamped(int count, BiquadFilter** filters, int length, float** inputs, float** outputs, const double* target) {
+	BiquadFilter* f = filters[0];
+	double start[5] = {f->b0, f->b1, f->b2, f->a1, f->a2}, delta[5], history[8] = {};
+	for(int k = 0; k < 5; k++) delta[k] = (target[k]-start[k])/length;
+	for(int i = 0; i < count; i++) {
+		history[i] = filters[i]->h1;
+		history[4+i] = filters[i]->h2;
+	}
+	biquadRampLanesKernel(count, length, inputs, outputs, start, delta, history);
+	for(int i = 0; i < count; i++) {
+		filters[i]->h1 = history[i];
+		filters[i]->h2 = history[4+i];
+		filters[i]->b0 = target[0];
+		filters[i]->b1 = target[1];
+		filters[i]->b2 = target[2];
+		filters[i]->a1 = target[3];
+		filters[i]->a2 = target[4];
+	}
+}
+
+//Drops the low mantissa bits, keeping 14.
+static double quantizeParameter(double x) {
+	uint64_t bits;
+	memcpy(&bits, &x, sizeof(double));
+	bits &= ~((uint64_t(1) << 38)-1);
+	memcpy(&x, &bits, sizeof(double));
+	return x;
+}
+
+class BiquadDesignCacheEntry {
+	public:
+	bool valid = false;
+	int type;
+	double sr, frequency, dbGain, q;
+	double coefficients[5];
+};
+
+const int BIQUAD_DESIGN_CACHE_SIZE = 256;
+thread_local BiquadDesignCacheEntry biquad_design_cache[BIQUAD_DESIGN_CACHE_SIZE];
+
+void biquadDesignCached(double sr, int type, double frequency, double dbGain, double q, double* coefficients) {
+	frequency = quantizeParameter(frequency);
+	dbGain = quantizeParameter(dbGain);
+	q = quantizeParameter(q);
+	uint64_t f, g, r;
+	memcpy(&f, &frequency, sizeof(double));
+	memcpy(&g, &dbGain, sizeof(double));
+	memcpy(&r, &q, sizeof(double));
+	uint64_t hash = ((f >> 38)*0x9E3779B97F4A7C15ull)^((g >> 38)*0xC2B2AE3D27D4EB4Full)^((r >> 38)*0x165667B19E3779F9ull)^(uint64_t)type;
+	auto &entry = biquad_design_cache[(hash >> 32)%BIQUAD_DESIGN_CACHE_SIZE];
+	if(entry.valid == false || entry.type != type || entry.sr != sr || entry.frequency != frequency || entry.dbGain != dbGain || entry.q != q) {
+		double a0, a1, a2, b0, b1, b2;
+		biquadConfigurationImplementation(sr, type, frequency, dbGain, q, b0, b1, b2, a0, a1, a2);
+		entry.coefficients[0] = b0/a0;
+		entry.coefficients[1] = b1/a0;
+		entry.coefficients[2] = b2/a0;
+		entry.coefficients[3] = a1/a0;
+		entry.coefficients[4] = a2/a0;
+		entry.valid = true;
+		entry.type = type;
+		entry.sr = sr;
+		entry.frequency = frequency;
+		entry.dbGain = dbGain;
+		entry.q = q;
+	}
+	std::copy(entry.coefficients, entry.coefficients+5, coefficients);
+}
+
 void biquadConfigurationImplementation(double sr, int type, double frequency, double dbGain, double q, double &b0, double &b1, double &b2, double &a0, double &a1, double &a2) {
 	//this entire function is a straightforward implementation of the Audio EQ cookbook, included with this repository.
 	//alias our parameters to match the Audio EQ cookbook.
@@ -0,0 +1,102 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#include <libaudioverse/implementations/block_biquad.hpp>
+#include <libaudioverse/implementations/biquad.hpp>
+#include <mmintrin.h>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+namespace libaudioverse_implementation {
+
+BlockBiquadFilter::BlockBiquadFilter(float _sr): sr(_sr) {
+	//Force the matrices to be computed for the identity filter.
+	b0 = 0.0;
+	setCoefficients(1.0, 0.0, 0.0, 0.0, 0.0);
+}
+
+void BlockBiquadFilter::configure(int type, double frequency, double dbGain, double q) {
+	double a0, a1, a2, b0, b1, b2;
+	biquadConfigurationImplementation(sr, type, frequency, dbGain, q, b0, b1, b2, a0, a1, a2);
+	setCoefficients(b0/a0, b1/a0, b2/a0, a1/a0, a2/a0);
+}
+
+void BlockBiquadFilter::setCoefficients(double b0, double b1, double b2, double a1, double a2) {
+	//Sources reconfigure every block, usually with the same values.
+	if(b0 == this->b0 && b1 == this->b1 && b2 == this->b2 && a1 == this->a1 && a2 == this->a2) return;
+	this->b0 = b0;
+	this->b1 = b1;
+	this->b2 = b2;
+	this->a1 = a1;
+	this->a2 = a2;
+	fb0 = (float)b0;
+	fb1 = (float)b1;
+	fb2 = (float)b2;
+	fa1 = (float)a1;
+	fa2 = (float)a2;
+	//Each row of the matrices is 4 steps of the recurrence, run in double from a unit state or a unit impulse.
+	for(int row = 0; row < 6; row++) {
+		double t1 = row == 0 ? 1.0 : 0.0, t2 = row == 1 ? 1.0 : 0.0;
+		float* outputs = row < 2 ? state_to_output[row] : input_to_output[row-2];
+		float* state = row < 2 ? state_to_state[row] : input_to_state[row-2];
+		for(int i = 0; i < 4; i++) {
+			double x = row-2 == i ? 1.0 : 0.0;
+			double y = b0*x+t1;
+			t1 = b1*x-a1*y+t2;
+			t2 = b2*x-a2*y;
+			outputs[i] = (float)y;
+		}
+		state[0] = (float)t1;
+		state[1] = (float)t2;
+		state[2] = 0.0f;
+		state[3] = 0.0f;
+	}
+}
+
+void BlockBiquadFilter::reset() {
+	s1 = 0.0f;
+	s2 = 0.0f;
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+void BlockBiquadFilter::process(int length, float* input, float* output) {
+	__m128 so0 = _mm_loadu_ps(state_to_output[0]), so1 = _mm_loadu_ps(state_to_output[1]);
+	__m128 io0 = _mm_loadu_ps(input_to_output[0]), io1 = _mm_loadu_ps(input_to_output[1]);
+	__m128 io2 = _mm_loadu_ps(input_to_output[2]), io3 = _mm_loadu_ps(input_to_output[3]);
+	__m128 ss0 = _mm_loadu_ps(state_to_state[0]), ss1 = _mm_loadu_ps(state_to_state[1]);
+	__m128 is0 = _mm_loadu_ps(input_to_state[0]), is1 = _mm_loadu_ps(input_to_state[1]);
+	__m128 is2 = _mm_loadu_ps(input_to_state[2]), is3 = _mm_loadu_ps(input_to_state[3]);
+	__m128 s = _mm_setr_ps(s1, s2, 0.0f, 0.0f);
+	int neededLength = length/4*4;
+	for(int i = 0; i < neededLength; i += 4) {
+		__m128 x = _mm_loadu_ps(input+i);
+		__m128 x0 = _mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 0, 0, 0)), x1 = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 x2 = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 2, 2)), x3 = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+		__m128 t1 = _mm_shuffle_ps(s, s, _MM_SHUFFLE(0, 0, 0, 0)), t2 = _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1));
+		//The input terms don't depend on the state, so only the last additions are on the critical path.
+		__m128 fromInput = _mm_add_ps(_mm_add_ps(_mm_mul_ps(io0, x0), _mm_mul_ps(io1, x1)), _mm_add_ps(_mm_mul_ps(io2, x2), _mm_mul_ps(io3, x3)));
+		__m128 y = _mm_add_ps(fromInput, _mm_add_ps(_mm_mul_ps(so0, t1), _mm_mul_ps(so1, t2)));
+		__m128 stateFromInput = _mm_add_ps(_mm_add_ps(_mm_mul_ps(is0, x0), _mm_mul_ps(is1, x1)), _mm_add_ps(_mm_mul_ps(is2, x2), _mm_mul_ps(is3, x3)));
+		s = _mm_add_ps(stateFromInput, _mm_add_ps(_mm_mul_ps(ss0, t1), _mm_mul_ps(ss1, t2)));
+		_mm_storeu_ps(output+i, y);
+	}
+	float tmp[4];
+	_mm_storeu_ps(tmp, s);
+	s1 = tmp[0];
+	s2 = tmp[1];
+	for(int i = neededLength; i < length; i++) output[i] = tick(input[i]);
+}
+
+#else
+
+void BlockBiquadFilter::process(int length, float* input, float* output) {
+	for(int i = 0; i < length; i++) output[i] = tick(input[i]);
+}
+
+#endif
+
+}
\ No newline at end of file
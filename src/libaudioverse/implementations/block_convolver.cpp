@@ -33,26 +33,31 @@ void BlockConvolver::setResponse(int length, float* newResponse) {
 		response=allocArray<float>(length);
 	}
 	std::copy(newResponse, newResponse+length, response);
-	if(history == nullptr) {
-		history = allocArray<float>(block_size+length);
-	}
-	else if(length !=response_length) {
-		freeArray(history);
-		history = allocArray<float>(block_size+length);
+	//Output needs the block and the length-1 samples before it.
+	int newCapacity = block_size+length-1;
+	if(history == nullptr || newCapacity != capacity) {
+		if(history) freeArray(history);
+		history = allocArray<float>(2*newCapacity);
+		capacity = newCapacity;
+		position = 0;
 	}
 	response_length= length;
 }
 
 void BlockConvolver::convolve(float* input, float* output) {
-	//First, move the history back.
-	int historyLength =response_length+block_size;
-	std::copy(history+historyLength-response_length, history+historyLength, history);
-	std::copy(input, input+block_size, history+historyLength-block_size);
-	convolutionKernel(history, block_size, output, response_length, response);
+	//Every sample is written twice, capacity apart, so that the last capacity samples are always contiguous and nothing has to be shifted.
+	int first = std::min(block_size, capacity-position);
+	std::copy(input, input+first, history+position);
+	std::copy(input, input+first, history+position+capacity);
+	std::copy(input+first, input+block_size, history);
+	std::copy(input+first, input+block_size, history+capacity);
+	position = (position+block_size)%capacity;
+	convolutionKernel(history+position, block_size, output, response_length, response);
 }
 
 void BlockConvolver::reset() {
-	std::fill(history, history+block_size+response_length, 0.0f);
+	std::fill(history, history+2*capacity, 0.0f);
+	position = 0;
 }
 
 }
\ No newline at end of file
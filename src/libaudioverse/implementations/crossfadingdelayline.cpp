@@ -6,6 +6,7 @@ A copy of both licenses may be found in license.gpl and license.mpl at the root
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #include <libaudioverse/private/dspmath.hpp>
 #include <libaudioverse/implementations/delayline.hpp>
+#include <libaudioverse/private/kernels.hpp>
 #include <algorithm>
 #include <functional>
 #include <math.h>
@@ -49,27 +50,44 @@ float CrossfadingDelayLine::tick(float sample) {
 }
 
 void CrossfadingDelayLine::processBuffer(int length, float* input, float* output) {
-	int cf = std::min(counter, length);
-	int remaining =length-cf;
-	float sample;
-	for(int i = 0; i < cf; i++) {
-		sample=input[i]; //save in case of in-place.
-		output[i] = weight1*line.read(delay)+weight2*line.read(new_delay);
-		line.advance(sample);
-		counter--;
-		weight1-=interpolation_delta;
-		weight2+=interpolation_delta;
+	//Delays shorter than the block would need many small reads, so when we aren't crossfading we write first and read back.
+	//This works as long as the write doesn't wrap around onto the samples we need.
+	int available = (int)line.getLength()-1-(int)delay;
+	if(counter == 0 && (int)delay+1 < length && available >= length) {
+		line.writeBlock(length, input);
+		line.readBlock(delay+length, length, output);
+		return;
 	}
-	if(counter == 0 && cf > 0) { //we crossfaded, but finished this block.
-		weight1 =1.0f;
-		weight2=0.0f;
-		delay = new_delay;
+	processDelayLineBuffer(*this, length, input, output);
+}
+
+int CrossfadingDelayLine::readBlock(int length, float* output) {
+	if(counter == 0) {
+		length = std::min<int>(length, delay+1);
+		line.readBlock(delay, length, output);
+		return length;
 	}
-	//We might have a bit more.
-	for(int i = cf; i < length; i++) {
-		sample= input[i];
-		output[i] = line.read(delay);
-		line.advance(sample);
+	//Only read up to the end of the crossfade, so that the next read can use the new delay alone.
+	length = std::min<int>({length, (int)std::min(delay, new_delay)+1, counter, DELAY_LINE_BLOCK_LENGTH});
+	float faded[DELAY_LINE_BLOCK_LENGTH];
+	line.readBlock(delay, length, output);
+	line.readBlock(new_delay, length, faded);
+	crossfadeKernel(length, weight2, interpolation_delta, output, faded, output);
+	return length;
+}
+
+void CrossfadingDelayLine::writeBlock(int length, float* input) {
+	line.writeBlock(length, input);
+	if(counter) {
+		weight1 -= interpolation_delta*length;
+		weight2 += interpolation_delta*length;
+		counter -= length;
+		if(counter <= 0) {
+			counter = 0;
+			delay = new_delay;
+			weight1 = 1.0f;
+			weight2 = 0.0f;
+		}
 	}
 }
 
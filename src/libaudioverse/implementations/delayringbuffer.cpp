@@ -6,6 +6,7 @@ A copy of both licenses may be found in license.gpl and license.mpl at the root
 If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
 #include <libaudioverse/private/dspmath.hpp>
 #include <libaudioverse/implementations/delayline.hpp>
+#include <libaudioverse/private/kernels.hpp>
 #include <algorithm>
 #include <functional>
 #include <math.h>
@@ -29,6 +30,38 @@ float DelayRingbuffer::read(unsigned int offset) {
 	return buffer[(write_head-offset) & mask];
 }
 
+void DelayRingbuffer::readBlock(unsigned int offset, int length, float* output) {
+	unsigned int start = (write_head-offset) & mask;
+	//The block is contiguous unless it wraps past the end, in which case the rest is at the beginning.
+	int first = std::min<int>(length, buffer_length-start);
+	std::copy(buffer+start, buffer+start+first, output);
+	std::copy(buffer, buffer+length-first, output+first);
+}
+
+void DelayRingbuffer::readInterpolatedBlock(double offset, double velocity, int length, float* output) {
+	if(velocity == 0.0) {
+		//Constant delays are a blend of two integer reads.
+		unsigned int i1 = (unsigned int)offset;
+		float weight = (float)(offset-i1);
+		float older[DELAY_LINE_BLOCK_LENGTH];
+		for(int done = 0; done < length; done += DELAY_LINE_BLOCK_LENGTH) {
+			int count = std::min(length-done, DELAY_LINE_BLOCK_LENGTH);
+			//Both offsets move forward by the samples already read.
+			readBlock(i1-done, count, output+done);
+			readBlock(i1+1-done, count, older);
+			crossfadeKernel(count, weight, 0.0f, output+done, older, output+done);
+		}
+		return;
+	}
+	for(int i = 0; i < length; i++) {
+		double d = offset+i*velocity;
+		unsigned int i1 = (unsigned int)d;
+		float weight = (float)(d-i1);
+		float newer = buffer[(write_head+i-i1) & mask], older = buffer[(write_head+i-i1-1) & mask];
+		output[i] = newer+(older-newer)*weight;
+	}
+}
+
 unsigned int DelayRingbuffer::getLength() {
 	return buffer_length;
 }
@@ -38,6 +71,20 @@ void DelayRingbuffer::advance(float sample) {
 	buffer[write_head & mask] = sample;
 }
 
+void DelayRingbuffer::writeBlock(int length, float* input) {
+	//Anything more than a buffer's worth would be overwritten anyway.
+	if(length > (int)buffer_length) {
+		write_head += length-buffer_length;
+		input += length-buffer_length;
+		length = buffer_length;
+	}
+	unsigned int start = (write_head+1) & mask;
+	int first = std::min<int>(length, buffer_length-start);
+	std::copy(input, input+first, buffer+start);
+	std::copy(input+first, input+length, buffer);
+	write_head += length;
+}
+
 void DelayRingbuffer::write(unsigned int offset, float value) {
 	buffer[(write_head-offset) & mask] = value;
 }
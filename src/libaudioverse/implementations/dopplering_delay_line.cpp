@@ -23,7 +23,7 @@ void DoppleringDelayLine::setDelay(float d) {
 		delay = new_delay;
 		counter = 0;
 	}
-	new_delay = d*sr;
+	new_delay = std::min<double>(d*sr, max_delay-1);
 	counter = interpolation_time*sr;
 	if(counter == 0) counter=1;
 	if(sr*interpolation_time !=0.0) velocity = (new_delay-delay)/(sr*interpolation_time);
@@ -38,7 +38,7 @@ void DoppleringDelayLine::setDelayInSamples(int newDelay) {
 		delay = new_delay;
 		counter = 0;
 	}
-	new_delay = std::min(newDelay, max_delay);
+	new_delay = std::min(newDelay, max_delay-1);
 	counter = interpolation_time*sr;
 	if(counter == 0) counter=1;
 	if(sr*interpolation_time !=0.0) velocity = (new_delay-delay)/(sr*interpolation_time);
@@ -57,14 +57,56 @@ float DoppleringDelayLine::tick(float sample) {
 }
 
 float DoppleringDelayLine::computeSample() {
-	float w1 = delay-floorf(delay);
-	float w2 = 1-w1;
-	int i1 = (int)(delay);
-	int i2=i1+1;
-	//make sure neither of these is over max delay.
-	i1 =std::min(i1, max_delay);
-	i2=std::min(i2, max_delay);
-	return line.read(i1)*w1+line.read(i2)*w2;
+	//The delay is kept below max_delay, so both samples are in the line.
+	int i1 = (int)delay;
+	float w = (float)(delay-i1);
+	return line.read(i1)*(1.0f-w)+line.read(i1+1)*w;
+}
+
+void DoppleringDelayLine::processBuffer(int length, float* input, float* output) {
+	//Without feedback, input can be written before it's read, from the same samples shifted back by the count written.
+	//That isn't limited to delay+1 samples at a time like processDelayLineBuffer, as long as the line is long enough not to overwrite what's still to be read.
+	int chunk = (int)line.getLength()-max_delay-2;
+	if(chunk < 1) {
+		processDelayLineBuffer(*this, length, input, output);
+		return;
+	}
+	int done = 0;
+	while(done < length) {
+		int count = std::min(length-done, chunk);
+		//Stop at the end of the change, so that the rest is a constant delay.
+		if(counter) count = std::min(count, counter);
+		line.writeBlock(count, input+done);
+		line.readInterpolatedBlock(delay+count, counter ? velocity : 0.0, count, output+done);
+		advanceDelay(count);
+		done += count;
+	}
+}
+
+int DoppleringDelayLine::readBlock(int length, float* output) {
+	//The delay moves monotonically toward new_delay, so the smaller of the two bounds how far ahead we can read.
+	double shortest = counter ? std::min(delay, new_delay) : delay;
+	length = std::min(length, (int)shortest+1);
+	//Stop at the end of the change, so that the rest of the block is a constant delay.
+	if(counter) length = std::min(length, counter);
+	line.readInterpolatedBlock(delay, counter ? velocity : 0.0, length, output);
+	return length;
+}
+
+void DoppleringDelayLine::writeBlock(int length, float* input) {
+	line.writeBlock(length, input);
+	advanceDelay(length);
+}
+
+void DoppleringDelayLine::advanceDelay(int length) {
+	if(counter) {
+		delay += velocity*length;
+		counter -= length;
+		if(counter <= 0) {
+			counter = 0;
+			delay = new_delay;
+		}
+	}
 }
 
 void DoppleringDelayLine::advance(float sample) {
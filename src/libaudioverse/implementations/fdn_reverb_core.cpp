@@ -0,0 +1,192 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#include <libaudioverse/implementations/fdn_reverb_core.hpp>
+#include <libaudioverse/implementations/one_pole_filter.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <algorithm>
+#include <random>
+#include <mmintrin.h>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+namespace libaudioverse_implementation {
+
+FdnReverbCore::FdnReverbCore(float sr, float maxDelay, const int* seeds): sr(sr) {
+	//We need room for the second sample of the interpolation past the longest delay.
+	unsigned int needed = (unsigned int)(maxDelay*sr)+2;
+	frame_count = 1;
+	while(frame_count < needed) frame_count <<= 1;
+	mask = frame_count-1;
+	buffer = allocArray<float>(frame_count*8);
+	base_delays = allocArray<float>(8);
+	delays = allocArray<float>(8);
+	feedback_gains = allocArray<float>(8);
+	filter_history = allocArray<float>(8);
+	modulator_from = allocArray<float>(8);
+	modulator_to = allocArray<float>(8);
+	modulator_weight = allocArray<float>(8);
+	for(int i = 0; i < 8; i++) {
+		engines[i].seed(seeds[i]);
+		distributions[i] = std::normal_distribution<float>(0.0f, 0.5f);
+		modulator_to[i] = drawTarget(i);
+	}
+}
+
+FdnReverbCore::~FdnReverbCore() {
+	freeArray(buffer);
+	freeArray(base_delays);
+	freeArray(delays);
+	freeArray(feedback_gains);
+	freeArray(filter_history);
+	freeArray(modulator_from);
+	freeArray(modulator_to);
+	freeArray(modulator_weight);
+}
+
+void FdnReverbCore::setDelays(const float* newDelays) {
+	for(int i = 0; i < 8; i++) {
+		base_delays[i] = std::min(newDelays[i]*sr, (float)frame_count-2.0f);
+		delays[i] = base_delays[i];
+	}
+}
+
+void FdnReverbCore::setFeedbackGains(const float* gains) {
+	std::copy(gains, gains+8, feedback_gains);
+}
+
+void FdnReverbCore::setCutoff(float frequency) {
+	OnePoleFilter design(sr);
+	design.setPoleFromFrequency(frequency);
+	b0 = design.b0;
+	a1 = design.a1;
+}
+
+void FdnReverbCore::setModulation(float depth, float frequency) {
+	modulating = depth != 0.0f && frequency != 0.0f;
+	modulation_depth = depth*sr;
+	modulation_delta = frequency/sr;
+}
+
+float FdnReverbCore::drawTarget(int line) {
+	float rnd;
+	do {
+		rnd = distributions[line](engines[line]);
+	} while(rnd < -1.0f || rnd > 1.0f);
+	return rnd;
+}
+
+void FdnReverbCore::nextTargets() {
+	for(int i = 0; i < 8; i++) {
+		if(modulator_weight[i] <= 1.0f) continue;
+		modulator_from[i] = modulator_to[i];
+		modulator_to[i] = drawTarget(i);
+		modulator_weight[i] = 0.0f;
+	}
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+void FdnReverbCore::process(int length, float** inputs, float** outputs) {
+	__m128 gainsLow = _mm_load_ps(feedback_gains), gainsHigh = _mm_load_ps(feedback_gains+4);
+	__m128 historyLow = _mm_load_ps(filter_history), historyHigh = _mm_load_ps(filter_history+4);
+	__m128 b0r = _mm_set1_ps(b0), a1r = _mm_set1_ps(a1);
+	//2/n, for the householder reflection.
+	__m128 reflection = _mm_set1_ps(0.25f);
+	__m128 depth = _mm_set1_ps(modulation_depth), delta = _mm_set1_ps(modulation_delta);
+	__m128 one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps(), longest = _mm_set1_ps((float)frame_count-2.0f);
+	int whole[8];
+	float newer[8], older[8], out[4];
+	for(int sample = 0; sample < length; sample++) {
+		__m128 delaysLow = _mm_load_ps(delays), delaysHigh = _mm_load_ps(delays+4);
+		__m128i wholeLow = _mm_cvttps_epi32(delaysLow), wholeHigh = _mm_cvttps_epi32(delaysHigh);
+		__m128 fractionLow = _mm_sub_ps(delaysLow, _mm_cvtepi32_ps(wholeLow));
+		__m128 fractionHigh = _mm_sub_ps(delaysHigh, _mm_cvtepi32_ps(wholeHigh));
+		_mm_storeu_si128((__m128i*)whole, wholeLow);
+		_mm_storeu_si128((__m128i*)(whole+4), wholeHigh);
+		//Every line reads at a different position, so this part is scalar.
+		for(int i = 0; i < 8; i++) {
+			unsigned int frame = (write_head-whole[i]) & mask;
+			newer[i] = buffer[frame*8+i];
+			older[i] = buffer[((frame-1) & mask)*8+i];
+		}
+		__m128 newerLow = _mm_loadu_ps(newer), newerHigh = _mm_loadu_ps(newer+4);
+		__m128 valuesLow = _mm_add_ps(newerLow, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(older), newerLow), fractionLow));
+		__m128 valuesHigh = _mm_add_ps(newerHigh, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(older+4), newerHigh), fractionHigh));
+		_mm_storeu_ps(out, valuesHigh);
+		for(int i = 0; i < 4; i++) outputs[i][sample] = out[i];
+		//Householder reflection: subtract 2/n of the sum from every line.
+		__m128 sum = _mm_add_ps(valuesLow, valuesHigh);
+		sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_mul_ps(sum, reflection);
+		__m128 feedbackLow = _mm_mul_ps(_mm_sub_ps(valuesLow, sum), gainsLow);
+		__m128 feedbackHigh = _mm_mul_ps(_mm_sub_ps(valuesHigh, sum), gainsHigh);
+		historyLow = _mm_sub_ps(_mm_mul_ps(b0r, feedbackLow), _mm_mul_ps(a1r, historyLow));
+		historyHigh = _mm_sub_ps(_mm_mul_ps(b0r, feedbackHigh), _mm_mul_ps(a1r, historyHigh));
+		__m128 input = _mm_setr_ps(inputs[0][sample], inputs[1][sample], inputs[2][sample], inputs[3][sample]);
+		write_head++;
+		float* frame = buffer+(write_head & mask)*8;
+		_mm_store_ps(frame, _mm_add_ps(historyLow, input));
+		_mm_store_ps(frame+4, _mm_add_ps(historyHigh, input));
+		if(modulating == false) continue;
+		//Move the modulators, and set the delays for the next sample.
+		int needsTarget = 0;
+		for(int half = 0; half < 8; half += 4) {
+			__m128 from = _mm_load_ps(modulator_from+half), to = _mm_load_ps(modulator_to+half);
+			__m128 weight = _mm_load_ps(modulator_weight+half);
+			__m128 m = _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), weight));
+			//Modulation can't push a delay below 0, or past the end of the buffer.
+			__m128 d = _mm_add_ps(_mm_load_ps(base_delays+half), _mm_mul_ps(depth, m));
+			_mm_store_ps(delays+half, _mm_min_ps(_mm_max_ps(d, zero), longest));
+			weight = _mm_add_ps(weight, delta);
+			_mm_store_ps(modulator_weight+half, weight);
+			needsTarget |= _mm_movemask_ps(_mm_cmpgt_ps(weight, one));
+		}
+		if(needsTarget) nextTargets();
+	}
+	_mm_store_ps(filter_history, historyLow);
+	_mm_store_ps(filter_history+4, historyHigh);
+}
+
+#else
+
+void FdnReverbCore::process(int length, float** inputs, float** outputs) {
+	float values[8];
+	for(int sample = 0; sample < length; sample++) {
+		float sum = 0.0f;
+		for(int i = 0; i < 8; i++) {
+			int whole = (int)delays[i];
+			float fraction = delays[i]-whole;
+			unsigned int frame = (write_head-whole) & mask;
+			float newer = buffer[frame*8+i], older = buffer[((frame-1) & mask)*8+i];
+			values[i] = newer+(older-newer)*fraction;
+			sum += values[i];
+		}
+		for(int i = 0; i < 4; i++) outputs[i][sample] = values[i+4];
+		sum *= 0.25f;
+		write_head++;
+		float* frame = buffer+(write_head & mask)*8;
+		for(int i = 0; i < 8; i++) {
+			filter_history[i] = b0*(values[i]-sum)*feedback_gains[i]-a1*filter_history[i];
+			frame[i] = filter_history[i]+inputs[i%4][sample];
+		}
+		if(modulating == false) continue;
+		bool needsTarget = false;
+		for(int i = 0; i < 8; i++) {
+			float m = modulator_from[i]+(modulator_to[i]-modulator_from[i])*modulator_weight[i];
+			//Modulation can't push a delay below 0, or past the end of the buffer.
+			delays[i] = std::min(std::max(base_delays[i]+modulation_depth*m, 0.0f), (float)frame_count-2.0f);
+			modulator_weight[i] += modulation_delta;
+			needsTarget |= modulator_weight[i] > 1.0f;
+		}
+		if(needsTarget) nextTargets();
+	}
+}
+
+#endif
+
+}
\ No newline at end of file
@@ -7,11 +7,11 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/dspmath.hpp>
 #include <libaudioverse/private/kernels.hpp>
 #include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/fft.hpp>
 #include <libaudioverse/implementations/convolvers.hpp>
 #include <algorithm>
 #include <functional>
 #include <math.h>
-#include <kiss_fftr.h>
 
 namespace libaudioverse_implementation {
 
@@ -21,76 +21,61 @@ FftConvolver::FftConvolver(int blockSize): block_size(blockSize) {
 }
 
 FftConvolver::~FftConvolver() {
+	freeArrays();
+}
+
+void FftConvolver::freeArrays() {
 	if(workspace) freeArray(workspace);
 	if(tail) freeArray(tail);
-	if(fft) kiss_fftr_free(fft);
-	if(ifft) kiss_fftr_free(ifft);
+	if(response_real) freeArray(response_real);
+	if(response_imag) freeArray(response_imag);
+	if(block_real) freeArray(block_real);
+	if(block_imag) freeArray(block_imag);
 }
 
 void FftConvolver::setResponse(int length, float* newResponse) {
-	int neededLength= kiss_fftr_next_fast_size_real	(block_size+length);
-	int newTailSize=neededLength-block_size;
-	if(neededLength !=fft_size || tail_size !=newTailSize) {
-		if(workspace) freeArray(workspace);
-		workspace=allocArray<float>(neededLength);
-		if(tail) freeArray(tail);
-		tail=allocArray<float>(newTailSize);
-		fft_size=neededLength/2+1;
-		workspace_size=neededLength;
-		tail_size=newTailSize;
-		if(fft) kiss_fftr_free(fft);
-		fft = kiss_fftr_alloc(workspace_size, 0, nullptr, nullptr);
-		if(ifft) kiss_fftr_free(ifft);
-		ifft=kiss_fftr_alloc(workspace_size, 1, nullptr, nullptr);
-		if(response_fft) freeArray(response_fft);
-		response_fft=allocArray<kiss_fft_cpx>(fft_size);
-		if(block_fft) freeArray(block_fft);
-		block_fft=allocArray<kiss_fft_cpx>(fft_size);
+	int neededLength = fftSizeAtLeast(block_size+length);
+	if(neededLength != fft_size) {
+		freeArrays();
+		fft_size = neededLength;
+		plan = getFftPlan(fft_size);
+		bins = plan->getBinCount();
+		tail_size = fft_size-block_size;
+		workspace = allocArray<float>(fft_size);
+		tail = allocArray<float>(tail_size);
+		response_real = allocArray<float>(bins);
+		response_imag = allocArray<float>(bins);
+		block_real = allocArray<float>(bins);
+		block_imag = allocArray<float>(bins);
 	}
-	memset(workspace, 0, sizeof(float)*workspace_size);
-	//Store the fft of the response.
-	std::copy(newResponse, newResponse+length, workspace);
-	kiss_fftr(fft, workspace, response_fft);
+	memset(workspace, 0, sizeof(float)*fft_size);
+	//Store the fft of the response, with the inverse fft's scale folded in.
+	scalarMultiplicationKernel(length, 1.0f/fft_size, newResponse, workspace);
+	plan->forward(workspace, response_real, response_imag);
 }
 
 void FftConvolver::convolve(float* input, float* output) {
-	convolveFft(getFft(input), output);
-}
-
-int FftConvolver::getFftSize() {
-	return workspace_size;
-}
-
-kiss_fft_cpx *FftConvolver::getFft(float* input) {
 	//We reuse workspace, so have to zero the tail part of it.
-	std::fill(workspace+block_size, workspace+workspace_size, 0.0);
-	//Copy input to the workspace, and take its fft.
+	std::fill(workspace+block_size, workspace+fft_size, 0.0f);
 	std::copy(input, input+block_size, workspace);
-	kiss_fftr(fft, workspace, block_fft);
-	return block_fft;
-}
-
-void FftConvolver::convolveFft(kiss_fft_cpx *fft, float* output) {
+	plan->forward(workspace, block_real, block_imag);
 	//Do a complex multiply.
-	//Note that the first line is subtraction because of the i^2.
-	for(int i=0; i < fft_size; i++) {
-		kiss_fft_cpx tmp;
-		tmp.r = fft[i].r*response_fft[i].r-fft[i].i*response_fft[i].i;
-		tmp.i = fft[i].r*response_fft[i].i+fft[i].i*response_fft[i].r;
-		block_fft[i] = tmp;
+	//Note that the real part is a subtraction because of the i^2.
+	for(int i = 0; i < bins; i++) {
+		float real = block_real[i]*response_real[i]-block_imag[i]*response_imag[i];
+		block_imag[i] = block_real[i]*response_imag[i]+block_imag[i]*response_real[i];
+		block_real[i] = real;
 	}
-	kiss_fftri(ifft, block_fft, workspace);
+	plan->inverse(block_real, block_imag, workspace);
 	//Add the tail over the block.
 	additionKernel(tail_size, tail, workspace, workspace);
-	//Downscale the first part, our output.
-	//Also copy to the output at the same time.
-	scalarMultiplicationKernel(block_size, 1.0/workspace_size, workspace, output);
+	std::copy(workspace, workspace+block_size, output);
 	//Copy out the tail.
-		std::copy(workspace+block_size, workspace+workspace_size, tail);
+	std::copy(workspace+block_size, workspace+fft_size, tail);
 }
 
 void FftConvolver::reset() {
-	std::fill(workspace, workspace+workspace_size, 0.0f);
+	std::fill(workspace, workspace+fft_size, 0.0f);
 	std::fill(tail, tail+tail_size, 0.0f);
 }
 
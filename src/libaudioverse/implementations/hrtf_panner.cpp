@@ -31,6 +31,19 @@ HrtfPanner::HrtfPanner(int _block_size, float _sr, std::shared_ptr<HrtfData> _hr
 	prev_right_convolver = new BlockConvolver(block_size);
 	left_convolver->setResponse(response_length, left_response_ptr);
 	right_convolver->setResponse(response_length, right_response_ptr);
+	setFrequencyDomain(chooseConvolutionEngine(block_size, response_length) != ConvolutionEngine::DIRECT);
+	if(hrtf->hasDelays()) {
+		//Room for a block as well, so that processBuffer handles one in a single pass.
+		float maxDelay = (hrtf->getMaxDelay()+block_size+2.0f)/sr;
+		left_delay_line = new DoppleringDelayLine(maxDelay, sr);
+		right_delay_line = new DoppleringDelayLine(maxDelay, sr);
+		//Start at the right delay, then glide over a block whenever it changes, which is often enough that the pitch shift isn't audible.
+		left_delay_line->setInterpolationTime(0.0f);
+		right_delay_line->setInterpolationTime(0.0f);
+		setDelays();
+		left_delay_line->setInterpolationTime(block_size/sr);
+		right_delay_line->setInterpolationTime(block_size/sr);
+	}
 }
 
 HrtfPanner::~HrtfPanner() {
@@ -38,44 +51,83 @@ HrtfPanner::~HrtfPanner() {
 	delete right_convolver;
 	delete prev_left_convolver;
 	delete prev_right_convolver;
+	if(frequency_convolver) delete frequency_convolver;
+	if(left_delay_line) delete left_delay_line;
+	if(right_delay_line) delete right_delay_line;
 }
 
 void HrtfPanner::pan(float* input, float *left_output, float *right_output) {
+	bool moved = azimuth != prev_azimuth || elevation != prev_elevation;
 	//Do we need to crossfade? We do if we've moved more than the threshold and crossfading is being allowed.
 	bool needsCrossfade = should_crossfade && fabs(azimuth-prev_azimuth)+fabs(elevation-prev_elevation) >= crossfade_threshold;
-	if(azimuth != prev_azimuth || elevation != prev_elevation) {
+	if(frequency_domain) {
+		if(moved) {
+			//The free response becomes the current one, and the current one the one being faded from.
+			std::rotate(left_spectra, left_spectra+2, left_spectra+3);
+			std::rotate(right_spectra, right_spectra+2, right_spectra+3);
+			hrtf->computeSpectraStereo(elevation, azimuth, *spectra, left_spectra[0].get(), right_spectra[0].get());
+			frequency_convolver->setResponse(0, left_spectra[0], needsCrossfade);
+			frequency_convolver->setResponse(1, right_spectra[0], needsCrossfade);
+		}
+		float* outputs[] = {left_output, right_output};
+		frequency_convolver->convolve(input, outputs);
+	}
+	else {
+		if(moved) {
+			if(needsCrossfade) {
+				std::swap(left_convolver, prev_left_convolver);
+				std::swap(right_convolver, prev_right_convolver);
+				left_convolver->reset();
+				right_convolver->reset();
+			}
+			float* left_response_ptr, *right_response_ptr;
+			//With a grid, the responses are already computed and the convolvers copy straight out of it.
+			if(hrtf->hasGrid()) hrtf->getGridCoefficientsStereo(elevation, azimuth, left_response_ptr, right_response_ptr);
+			else {
+				left_response_ptr = left_response_workspace.get(response_length);
+				right_response_ptr = right_response_workspace.get(response_length);
+				hrtf->computeCoefficientsStereo(elevation, azimuth, left_response_ptr, right_response_ptr);
+			}
+			left_convolver->setResponse(response_length, left_response_ptr);
+			right_convolver->setResponse(response_length, right_response_ptr);
+		}
+		//These two convolutions always happen.
+		left_convolver->convolve(input, left_output);
+		right_convolver->convolve(input, right_output);
 		if(needsCrossfade) {
-			std::swap(left_convolver, prev_left_convolver);
-			std::swap(right_convolver, prev_right_convolver);
-			left_convolver->reset();
-			right_convolver->reset();
+			double delta = 1.0/block_size;
+			float* crossfade_ptr = crossfade_workspace.get(block_size);
+			prev_left_convolver->convolve(input, crossfade_ptr);
+			for(int i = 0; i < block_size; i++) left_output[i] = (block_size-i)*delta*crossfade_ptr[i]+i*delta*left_output[i];
+			prev_right_convolver->convolve(input, crossfade_ptr);
+			for(int i = 0; i < block_size; i++) right_output[i] = (block_size-i)*delta*crossfade_ptr[i]+i*delta*right_output[i];
 		}
-		float* left_response_ptr = left_response_workspace.get(response_length);
-		float* right_response_ptr = right_response_workspace.get(response_length);
-		hrtf->computeCoefficientsStereo(elevation, azimuth, left_response_ptr, right_response_ptr);
-		left_convolver->setResponse(response_length, left_response_ptr);
-		right_convolver->setResponse(response_length, right_response_ptr);
 	}
-	//These two convolutions always happen.
-	left_convolver->convolve(input, left_output);
-	right_convolver->convolve(input, right_output);
-	if(needsCrossfade) {
-		double delta = 1.0/block_size;
-		float* crossfade_ptr = crossfade_workspace.get(block_size);
-		prev_left_convolver->convolve(input, crossfade_ptr);
-		for(int i = 0; i < block_size; i++) left_output[i] = (block_size-i)*delta*crossfade_ptr[i]+i*delta*left_output[i];
-		prev_right_convolver->convolve(input, crossfade_ptr);
-		for(int i = 0; i < block_size; i++) right_output[i] = (block_size-i)*delta*crossfade_ptr[i]+i*delta*right_output[i];
+	//Minimum phase hrirs leave the interaural delay to us.
+	if(left_delay_line) {
+		if(moved) setDelays();
+		left_delay_line->processBuffer(block_size, left_output, left_output);
+		right_delay_line->processBuffer(block_size, right_output, right_output);
 	}
 	prev_azimuth = azimuth;
 	prev_elevation = elevation;
-}	
+}
+
+void HrtfPanner::setDelays() {
+	float left, right;
+	hrtf->computeDelaysStereo(elevation, azimuth, left, right);
+	left_delay_line->setDelay(left/sr);
+	right_delay_line->setDelay(right/sr);
+}
 
 void HrtfPanner::reset() {
 	left_convolver->reset();
 	right_convolver->reset();
 	prev_left_convolver->reset();
 	prev_right_convolver->reset();
+	if(frequency_convolver) frequency_convolver->reset();
+	if(left_delay_line) left_delay_line->reset();
+	if(right_delay_line) right_delay_line->reset();
 }
 
 void HrtfPanner::setAzimuth(float angle) {
@@ -110,5 +162,37 @@ float HrtfPanner::getCrossfadeThreshold() {
 	return crossfade_threshold;
 }
 
+void HrtfPanner::setFrequencyDomain(bool fd) {
+	if(fd && frequency_convolver == nullptr) {
+		spectra = hrtf->getSpectra(block_size);
+		frequency_convolver = new PartitionedConvolver(block_size, 2);
+		for(int i = 0; i < 3; i++) {
+			left_spectra[i] = std::make_shared<PartitionedResponse>(block_size, response_length);
+			right_spectra[i] = std::make_shared<PartitionedResponse>(block_size, response_length);
+		}
+	}
+	if(fd && frequency_domain == false) {
+		//The time domain's convolvers stay at the direction they were last used for, so this always has to catch up.
+		hrtf->computeSpectraStereo(prev_elevation, prev_azimuth, *spectra, left_spectra[0].get(), right_spectra[0].get());
+		frequency_convolver->setResponse(0, left_spectra[0]);
+		frequency_convolver->setResponse(1, right_spectra[0]);
+		frequency_convolver->reset();
+	}
+	else if(fd == false && frequency_domain) {
+		float* left_response_ptr = left_response_workspace.get(response_length);
+		float* right_response_ptr = right_response_workspace.get(response_length);
+		hrtf->computeCoefficientsStereo(prev_elevation, prev_azimuth, left_response_ptr, right_response_ptr);
+		left_convolver->setResponse(response_length, left_response_ptr);
+		right_convolver->setResponse(response_length, right_response_ptr);
+		left_convolver->reset();
+		right_convolver->reset();
+	}
+	frequency_domain = fd;
+}
+
+bool HrtfPanner::getFrequencyDomain() {
+	return frequency_domain;
+}
+
 
 }
\ No newline at end of file
@@ -19,6 +19,8 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <stdio.h>
 #include <string.h>
 #include <libaudioverse/private/error.hpp>
+#include <libaudioverse/private/dspmath.hpp>
+#include <libaudioverse/private/kernels.hpp>
 
 namespace libaudioverse_implementation {
 
@@ -26,6 +28,13 @@ IIRFilter::IIRFilter(double sr) {
 	this->sr = sr;
 }
 
+IIRFilter::~IIRFilter() {
+	if(history) delete[] history;
+	if(numerator) delete[] numerator;
+	if(denominator) delete[] denominator;
+	if(recursion_history) delete[] recursion_history;
+}
+
 void IIRFilter::configure(int newNumeratorLength, double* newNumerator, int newDenominatorLength, double* newDenominator) {
 	if(newNumeratorLength == 0 || newDenominatorLength == 0) ERROR(Lav_ERROR_RANGE, "Both numerator and denominator must have nonzero length.");
 	//we normalize by the first coefficient but throw it out; consequently, it must be nonzero.
@@ -44,19 +53,48 @@ void IIRFilter::configure(int newNumeratorLength, double* newNumerator, int newD
 	std::copy(newDenominator, newDenominator+newDenominatorLength, denominator);
 	numerator_length= newNumeratorLength;
 	denominator_length = newDenominatorLength;
-	for(int i = 0; i <denominator_length; i++) denominator[i]/=denominator[0];
+	//The transfer function is unchanged if we divide both sides by a0, which the direct form needs to be 1.
+	double a0 = denominator[0];
+	for(int i = 0; i < numerator_length; i++) numerator[i] /= a0;
+	for(int i = 0; i <denominator_length; i++) denominator[i] /= a0;
+	int oldSectionCount = (int)unscaled_sections.size()/5;
+	if(factorSecondOrderSections(numerator_length, numerator, denominator_length, denominator, unscaled_sections) == false) unscaled_sections.clear();
+	//Keep the history if the structure didn't change, so that the caller can choose not to clear it.
+	if((int)unscaled_sections.size()/5 != oldSectionCount) section_history.assign(unscaled_sections.size()/5*2, 0.0);
+	rebuildSections();
+}
+
+void IIRFilter::rebuildSections() {
+	sections = unscaled_sections;
+	if(sections.size()) for(int i = 0; i < 3; i++) sections[i] *= gain;
+}
+
+bool IIRFilter::usesSections() {
+	return sections.size() != 0;
 }
 
 void IIRFilter::clearHistories() {
 	if(numerator_length) memset(history, 0, sizeof(double)*numerator_length);
 	if(denominator_length) memset(recursion_history, 0, sizeof(double)*denominator_length);
+	std::fill(section_history.begin(), section_history.end(), 0.0);
 }
 
 void IIRFilter::setGain(double gain) {
 	this->gain = gain;
+	rebuildSections();
+}
+
+void IIRFilter::process(int length, float* input, float* output) {
+	if(usesSections()) biquadCascadeKernel((int)sections.size()/5, length, input, output, &sections[0], &section_history[0]);
+	else for(int i = 0; i < length; i++) output[i] = tick(input[i]);
 }
 
 float IIRFilter::tick(float sample) {
+	if(usesSections()) {
+		float out;
+		biquadCascadeKernel((int)sections.size()/5, 1, &sample, &out, &sections[0], &section_history[0]);
+		return out;
+	}
 	int i;
 	history[0] = sample*gain;
 	recursion_history[0] = 0.0;
@@ -18,12 +18,12 @@ InterpolatedDelayLine::InterpolatedDelayLine(float maxDelay, float sr): line((in
 }
 
 void InterpolatedDelayLine::setDelay(float d) {
-	delay = d*sr;
+	delay = std::min<double>(d*sr, max_delay-1);
 	if(slave) slave->setDelay(d);
 }
 
 void InterpolatedDelayLine::setDelayInSamples(int samples) {
-	delay = std::min(samples, max_delay);
+	delay = std::min(samples, max_delay-1);
 	if(slave) slave->setDelayInSamples(samples);
 }
 
@@ -34,14 +34,24 @@ float InterpolatedDelayLine::tick(float sample) {
 }
 
 float InterpolatedDelayLine::computeSample() {
-	float w1 = delay-floorf(delay);
-	float w2 = 1-w1;
-	int i1 = (int)(delay);
-	int i2=i1+1;
-	//make sure neither of these is over max delay.
-	i1 =std::min(i1, max_delay);
-	i2=std::min(i2, max_delay);
-	return line.read(i1)*w1+line.read(i2)*w2;
+	//The delay is kept below max_delay, so both samples are in the line.
+	int i1 = (int)delay;
+	float w = (float)(delay-i1);
+	return line.read(i1)*(1.0f-w)+line.read(i1+1)*w;
+}
+
+void InterpolatedDelayLine::processBuffer(int length, float* input, float* output) {
+	processDelayLineBuffer(*this, length, input, output);
+}
+
+int InterpolatedDelayLine::readBlock(int length, float* output) {
+	length = std::min(length, (int)delay+1);
+	line.readInterpolatedBlock(delay, 0.0, length, output);
+	return length;
+}
+
+void InterpolatedDelayLine::writeBlock(int length, float* input) {
+	line.writeBlock(length, input);
 }
 
 void InterpolatedDelayLine::advance(float sample) {
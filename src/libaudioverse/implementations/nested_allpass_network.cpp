@@ -32,7 +32,6 @@ NestedAllpassNetworkASTNode::~NestedAllpassNetworkASTNode() {
 	if(type == NestedAllpassNetworkASTTypes::ALLPASS || type == NestedAllpassNetworkASTTypes::NESTED_ALLPASS) delete (AllpassFilter<InterpolatedDelayLine>*)filter;
 	else if(type == NestedAllpassNetworkASTTypes::ONE_POLE) delete (OnePoleFilter*)filter;
 	else if(type == NestedAllpassNetworkASTTypes::BIQUAD) delete (BiquadFilter*)filter;
-	else if(type == NestedAllpassNetworkASTTypes::BIQUAD) delete (BiquadFilter*)filter;
 }
 
 //Tick and reset follow a similar pattern.
@@ -83,6 +82,11 @@ static void freeAST(NestedAllpassNetworkASTNode* start) {
 	NestedAllpassNetworkASTNode *next = start->next, *nested = start->nested;
 	freeAST(next);
 	freeAST(nested);
+	delete start;
+}
+
+NestedAllpassNetworkInstruction::NestedAllpassNetworkInstruction(NestedAllpassNetworkOpcodes opcode, float sr): one_pole(sr), biquad(sr) {
+	this->opcode = opcode;
 }
 
 NestedAllpassNetwork::~NestedAllpassNetwork() {
@@ -95,6 +99,7 @@ void NestedAllpassNetwork::beginNesting(int delay, float coefficient) {
 	filter->line.setDelayInSamples(delay);
 	filter->setCoefficient(coefficient);
 	auto node = new NestedAllpassNetworkASTNode(this, NestedAllpassNetworkASTTypes::NESTED_ALLPASS, filter);
+	node->delay = delay;
 	hookupAST(node);
 	//Now move current to the stack and kill it.
 	stack.push_back(current);
@@ -115,6 +120,7 @@ void NestedAllpassNetwork::appendAllpass(int delay, float coefficient) {
 	f->setCoefficient(coefficient);
 	f->line.setDelayInSamples(delay);
 	auto n = new NestedAllpassNetworkASTNode(this, NestedAllpassNetworkASTTypes::ALLPASS, f);
+	n->delay = delay;
 	hookupAST(n);
 	if(slave) slave->appendAllpass(delay, coefficient);
 }
@@ -150,13 +156,57 @@ void NestedAllpassNetwork::compile() {
 		stack.back()->nested = n;
 	}
 	//start becomes next_start, clear everything else.
+	//The program points into the old tree, so it goes first.
+	program.clear();
+	freeAST(start);
 	start = next_start;
 	current = nullptr;
 	next_start = nullptr;
 	stack.clear();
+	chunk_length = DELAY_LINE_BLOCK_LENGTH;
+	max_depth = 0;
+	emitRow(start, 0);
+	sample_stack.assign(max_depth, 0.0f);
+	//One block for the input to the program, plus one per level of nesting.
+	block_stack.assign((max_depth+1)*DELAY_LINE_BLOCK_LENGTH, 0.0f);
 	if(slave) slave->compile();
 }
 
+void NestedAllpassNetwork::emitRow(NestedAllpassNetworkASTNode* row, int depth) {
+	max_depth = std::max(max_depth, depth);
+	for(auto node = row; node; node = node->next) {
+		switch(node->type) {
+			case NestedAllpassNetworkASTTypes::IDENTITY: break;
+			case NestedAllpassNetworkASTTypes::READER:
+			program.emplace_back(NestedAllpassNetworkOpcodes::READER, sr);
+			program.back().reader_mul = node->reader_mul;
+			break;
+			case NestedAllpassNetworkASTTypes::ONE_POLE:
+			program.emplace_back(NestedAllpassNetworkOpcodes::ONE_POLE, sr);
+			program.back().one_pole = *static_cast<OnePoleFilter*>(node->filter);
+			break;
+			case NestedAllpassNetworkASTTypes::BIQUAD:
+			program.emplace_back(NestedAllpassNetworkOpcodes::BIQUAD, sr);
+			program.back().biquad = *static_cast<BiquadFilter*>(node->filter);
+			break;
+			case NestedAllpassNetworkASTTypes::ALLPASS:
+			chunk_length = std::min(chunk_length, node->delay+1);
+			program.emplace_back(NestedAllpassNetworkOpcodes::ALLPASS, sr);
+			program.back().allpass = static_cast<AllpassFilter<InterpolatedDelayLine>*>(node->filter);
+			break;
+			case NestedAllpassNetworkASTTypes::NESTED_ALLPASS:
+			//The nested row can only run as many samples as the line has already got.
+			chunk_length = std::min(chunk_length, node->delay+1);
+			program.emplace_back(NestedAllpassNetworkOpcodes::BEGIN_NESTED, sr);
+			program.back().allpass = static_cast<AllpassFilter<InterpolatedDelayLine>*>(node->filter);
+			emitRow(node->nested, depth+1);
+			program.emplace_back(NestedAllpassNetworkOpcodes::END_NESTED, sr);
+			program.back().allpass = static_cast<AllpassFilter<InterpolatedDelayLine>*>(node->filter);
+			break;
+		}
+	}
+}
+
 void NestedAllpassNetwork::hookupAST(NestedAllpassNetworkASTNode *node) {
 	if(current == nullptr && stack.empty()) {
 		//We just began a new network.
@@ -181,6 +231,59 @@ void NestedAllpassNetwork::contribute(float amount) {
 }
 
 float NestedAllpassNetwork::tick(float input) {
+	float value = input, output = 0.0f;
+	int depth = 0;
+	for(auto &i: program) {
+		switch(i.opcode) {
+			case NestedAllpassNetworkOpcodes::ALLPASS: value = i.allpass->tick(value); break;
+			case NestedAllpassNetworkOpcodes::BEGIN_NESTED:
+			sample_stack[depth++] = value;
+			value = i.allpass->beginNestedTick();
+			break;
+			case NestedAllpassNetworkOpcodes::END_NESTED: value = i.allpass->endNestedTick(sample_stack[--depth], value); break;
+			case NestedAllpassNetworkOpcodes::ONE_POLE: value = i.one_pole.tick(value); break;
+			case NestedAllpassNetworkOpcodes::BIQUAD: value = i.biquad.tick(value); break;
+			case NestedAllpassNetworkOpcodes::READER: output += value*i.reader_mul; break;
+		}
+	}
+	return output;
+}
+
+void NestedAllpassNetwork::process(int length, float* input, float* output) {
+	for(int done = 0; done < length; done += chunk_length) {
+		int count = std::min(chunk_length, length-done);
+		//The current value lives at block_stack[depth*DELAY_LINE_BLOCK_LENGTH]; the levels below it hold the values saved by BEGIN_NESTED.
+		float* value = &block_stack[0];
+		std::copy(input+done, input+done+count, value);
+		//Only now is it safe to clear the output, in case we are running in-place.
+		std::fill(output+done, output+done+count, 0.0f);
+		float recursion[DELAY_LINE_BLOCK_LENGTH];
+		for(auto &i: program) {
+			switch(i.opcode) {
+				case NestedAllpassNetworkOpcodes::ALLPASS: i.allpass->process(count, value, value); break;
+				case NestedAllpassNetworkOpcodes::BEGIN_NESTED:
+				value += DELAY_LINE_BLOCK_LENGTH;
+				i.allpass->line.readBlock(count, value);
+				break;
+				case NestedAllpassNetworkOpcodes::END_NESTED: {
+					//endNestedTick, a block at a time.  The result replaces the saved input.
+					float* saved = value-DELAY_LINE_BLOCK_LENGTH;
+					float c = i.allpass->coefficient;
+					multiplicationAdditionKernel(count, -c, value, saved, recursion);
+					multiplicationAdditionKernel(count, c, recursion, value, saved);
+					i.allpass->line.writeBlock(count, recursion);
+					value = saved;
+					break;
+				}
+				case NestedAllpassNetworkOpcodes::ONE_POLE: for(int j = 0; j < count; j++) value[j] = i.one_pole.tick(value[j]); break;
+				case NestedAllpassNetworkOpcodes::BIQUAD: for(int j = 0; j < count; j++) value[j] = i.biquad.tick(value[j]); break;
+				case NestedAllpassNetworkOpcodes::READER: multiplicationAdditionKernel(count, i.reader_mul, value, output+done, output+done); break;
+			}
+		}
+	}
+}
+
+float NestedAllpassNetwork::tickInterpreted(float input) {
 	next_output = 0.0f;
 	if(start) start->tickRow(input);
 	return next_output;
@@ -188,6 +291,10 @@ float NestedAllpassNetwork::tick(float input) {
 
 void NestedAllpassNetwork::reset() {
 	if(start) start->reset();
+	for(auto &i: program) {
+		i.one_pole.reset();
+		i.biquad.reset();
+	}
 }
 
 NestedAllpassNetwork* NestedAllpassNetwork::getSlave() {
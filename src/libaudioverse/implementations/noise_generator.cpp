@@ -0,0 +1,226 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+/**Block-based noise generation.*/
+#include <libaudioverse/implementations/noise_generator.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/constants.hpp>
+#include <math.h>
+#include <algorithm>
+#include <mmintrin.h>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+namespace libaudioverse_implementation {
+
+//Standard deviation of the output.  More than 99.99% of samples are inside -1 to 1.
+const float noise_standard_deviation = 0.25f;
+
+//One step of xorshift32.  Each lane has its own state.
+static inline unsigned int xorshift32(unsigned int &x) {
+	x ^= x<<13;
+	x ^= x>>17;
+	x ^= x<<5;
+	return x;
+}
+
+//Uniform on (0, 1] and [0, 1) respectively, using the top 24 bits so the conversion to float is exact.
+static inline float uniformOpen(unsigned int x) {
+	return ((x>>8)+1)*(1.0f/16777216.0f);
+}
+
+static inline float uniformClosed(unsigned int x) {
+	return (x>>8)*(1.0f/16777216.0f);
+}
+
+NoiseGenerator::NoiseGenerator(unsigned int seed) {
+	state = allocArray<unsigned int>(4);
+	setSeed(seed);
+}
+
+NoiseGenerator::~NoiseGenerator() {
+	freeArray(state);
+	if(workspace) freeArray(workspace);
+}
+
+void NoiseGenerator::setSeed(unsigned int seed) {
+	//Xorshift can't have a zero state, and the lanes must not start out correlated.
+	//We spread the seed with a multiplicative hash, and run each lane forward a bit.
+	for(int i = 0; i < 4; i++) {
+		state[i] = (seed+i+1)*2654435761u;
+		if(state[i] == 0) state[i] = 1;
+		for(int j = 0; j < 16; j++) xorshift32(state[i]);
+	}
+}
+
+float NoiseGenerator::redraw() {
+	float sample;
+	do {
+		float r = sqrtf(-2.0f*logf(uniformOpen(xorshift32(state[0]))));
+		float theta = (float)(2*PI)*uniformClosed(xorshift32(state[0]));
+		sample = r*cosf(theta)*noise_standard_deviation;
+	} while(sample < -1.0f || sample > 1.0f);
+	return sample;
+}
+
+//Produces 8 samples per iteration, so count must be a multiple of 8.
+void whiteNoiseSimple(int count, unsigned int* state, float* output) {
+	for(int i = 0; i < count; i += 8) {
+		for(int lane = 0; lane < 4; lane++) {
+			float r = sqrtf(-2.0f*logf(uniformOpen(xorshift32(state[lane]))));
+			float theta = (float)(2*PI)*uniformClosed(xorshift32(state[lane]))-(float)PI;
+			output[i+lane] = r*cosf(theta)*noise_standard_deviation;
+			output[i+lane+4] = r*sinf(theta)*noise_standard_deviation;
+		}
+	}
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+static inline __m128i xorshift32x4(__m128i &x) {
+	x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+	x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+	return x;
+}
+
+//Natural log for 0 < x <= 1, accurate to about 1e-6.
+//Splits x into 2^e*m with m in [sqrt(2)/2, sqrt(2)), then uses the series for ln((1+t)/(1-t)).
+static inline __m128 logPositive(__m128 x) {
+	__m128i bits = _mm_castps_si128(x);
+	__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+	__m128 big = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+	m = _mm_or_ps(_mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(big, m));
+	e = _mm_add_ps(e, _mm_and_ps(big, _mm_set1_ps(1.0f)));
+	__m128 t = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+	__m128 t2 = _mm_mul_ps(t, t);
+	__m128 poly = _mm_add_ps(_mm_set1_ps(1.0f/7.0f), _mm_mul_ps(t2, _mm_set1_ps(1.0f/9.0f)));
+	poly = _mm_add_ps(_mm_set1_ps(1.0f/5.0f), _mm_mul_ps(t2, poly));
+	poly = _mm_add_ps(_mm_set1_ps(1.0f/3.0f), _mm_mul_ps(t2, poly));
+	poly = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t2, poly));
+	__m128 lnm = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f), t), poly);
+	return _mm_add_ps(lnm, _mm_mul_ps(e, _mm_set1_ps(0.69314718f)));
+}
+
+//Sine and cosine of 2*phi for phi in [-pi/2, pi/2], via Taylor series for phi and the double angle formulas.
+static inline void sinCosDoubled(__m128 phi, __m128 &s, __m128 &c) {
+	__m128 p2 = _mm_mul_ps(phi, phi);
+	__m128 sp = _mm_add_ps(_mm_set1_ps(-1.0f/5040.0f), _mm_mul_ps(p2, _mm_set1_ps(1.0f/362880.0f)));
+	sp = _mm_add_ps(_mm_set1_ps(1.0f/120.0f), _mm_mul_ps(p2, sp));
+	sp = _mm_add_ps(_mm_set1_ps(-1.0f/6.0f), _mm_mul_ps(p2, sp));
+	sp = _mm_mul_ps(phi, _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(p2, sp)));
+	__m128 cp = _mm_add_ps(_mm_set1_ps(1.0f/40320.0f), _mm_mul_ps(p2, _mm_set1_ps(-1.0f/3628800.0f)));
+	cp = _mm_add_ps(_mm_set1_ps(-1.0f/720.0f), _mm_mul_ps(p2, cp));
+	cp = _mm_add_ps(_mm_set1_ps(1.0f/24.0f), _mm_mul_ps(p2, cp));
+	cp = _mm_add_ps(_mm_set1_ps(-0.5f), _mm_mul_ps(p2, cp));
+	cp = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(p2, cp));
+	s = _mm_mul_ps(_mm_set1_ps(2.0f), _mm_mul_ps(sp, cp));
+	c = _mm_sub_ps(_mm_mul_ps(cp, cp), _mm_mul_ps(sp, sp));
+}
+
+void whiteNoise(int count, unsigned int* state, float* output) {
+	__m128i x = _mm_loadu_si128((__m128i*)state);
+	const __m128 scale = _mm_set1_ps(1.0f/16777216.0f);
+	const __m128 deviation = _mm_set1_ps(noise_standard_deviation);
+	for(int i = 0; i < count; i += 8) {
+		//u1 is in (0, 1] so that the log is finite.
+		__m128 u1 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_srli_epi32(xorshift32x4(x), 8), _mm_set1_epi32(1))), scale);
+		__m128 u2 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(xorshift32x4(x), 8)), scale);
+		//The log can come out slightly positive near 1, which would be a nan.
+		__m128 r = _mm_sqrt_ps(_mm_max_ps(_mm_mul_ps(_mm_set1_ps(-2.0f), logPositive(u1)), _mm_setzero_ps()));
+		//Theta is in [-pi, pi), which is as uniform as [0, 2pi).
+		__m128 phi = _mm_mul_ps(_mm_sub_ps(u2, _mm_set1_ps(0.5f)), _mm_set1_ps((float)PI));
+		__m128 s, c;
+		sinCosDoubled(phi, s, c);
+		r = _mm_mul_ps(r, deviation);
+		_mm_storeu_ps(output+i, _mm_mul_ps(r, c));
+		_mm_storeu_ps(output+i+4, _mm_mul_ps(r, s));
+	}
+	_mm_storeu_si128((__m128i*)state, x);
+}
+
+#else
+
+void whiteNoise(int count, unsigned int* state, float* output) {
+	whiteNoiseSimple(count, state, output);
+}
+
+#endif
+
+void NoiseGenerator::white(int length, float* output) {
+	int needed = (length+7)/8*8;
+	if(needed > workspace_length) {
+		if(workspace) freeArray(workspace);
+		workspace = allocArray<float>(needed);
+		workspace_length = needed;
+	}
+	whiteNoise(needed, state, workspace);
+	for(int i = 0; i < length; i++) {
+		float s = workspace[i];
+		//Only about 1 in 15000 samples gets redrawn.
+		output[i] = s < -1.0f || s > 1.0f ? redraw() : s;
+	}
+}
+
+PartialFractionFilter::PartialFractionFilter() {
+	poles = allocArray<float>(4);
+	residues = allocArray<float>(4);
+	state = allocArray<float>(4);
+}
+
+PartialFractionFilter::~PartialFractionFilter() {
+	freeArray(poles);
+	freeArray(residues);
+	freeArray(state);
+}
+
+void PartialFractionFilter::configure(int count, const double* newPoles, const double* newResidues, double newDirect) {
+	count = std::min(count, 4);
+	std::fill(poles, poles+4, 0.0f);
+	std::fill(residues, residues+4, 0.0f);
+	for(int i = 0; i < count; i++) {
+		poles[i] = (float)newPoles[i];
+		residues[i] = (float)newResidues[i];
+	}
+	direct = (float)newDirect;
+}
+
+void PartialFractionFilter::reset() {
+	std::fill(state, state+4, 0.0f);
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+void PartialFractionFilter::process(int length, float* input, float* output) {
+	__m128 p = _mm_load_ps(poles), r = _mm_load_ps(residues), s = _mm_load_ps(state);
+	for(int i = 0; i < length; i++) {
+		float in = input[i];
+		s = _mm_add_ps(_mm_mul_ps(s, p), _mm_mul_ps(r, _mm_set1_ps(in)));
+		//Horizontal sum, as in dotKernel.
+		__m128 sum = _mm_add_ps(s, _mm_movehl_ps(s, s));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		output[i] = _mm_cvtss_f32(sum)+direct*in;
+	}
+	_mm_store_ps(state, s);
+}
+
+#else
+
+void PartialFractionFilter::process(int length, float* input, float* output) {
+	for(int i = 0; i < length; i++) {
+		float in = input[i], out = direct*in;
+		for(int j = 0; j < 4; j++) {
+			state[j] = state[j]*poles[j]+residues[j]*in;
+			out += state[j];
+		}
+		output[i] = out;
+	}
+}
+
+#endif
+
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/implementations/convolvers.hpp>
+#include <powercores/thread_pool.hpp>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <memory>
+
+namespace libaudioverse_implementation {
+
+powercores::ThreadPool* convolution_threads = nullptr;
+
+void initializeConvolutionThreads() {
+	//Leave a core for the audio threads, if there is one.
+	int count = std::max(1, (int)std::thread::hardware_concurrency()-1);
+	convolution_threads = new powercores::ThreadPool(count);
+	convolution_threads->start();
+}
+
+void shutdownConvolutionThreads() {
+	if(convolution_threads == nullptr) return;
+	//Stopping runs whatever was already submitted.
+	convolution_threads->stop();
+	delete convolution_threads;
+	convolution_threads = nullptr;
+}
+
+/**One uniformly partitioned overlap-save convolver with partitions of partition_size.
+Input is collected a block at a time; when a partition's worth has arrived, the output for it is computed and played over the next partition's worth of blocks.
+In the background, the result instead arrives a partition later, which the stage's position in the response accounts for.*/
+class NonUniformConvolverStage {
+	public:
+	NonUniformConvolverStage(int blockSize, int partitionSize, bool background, int length, float* response);
+	~NonUniformConvolverStage();
+	//Adds this block's share of the stage's output to output, then takes the input.
+	void convolve(float* input, float* output);
+	void reset();
+	//Waits for the background work, if any.
+	void wait();
+	private:
+	void compute();
+	int block_size, partition_size, fft_size, bins, stride, partition_count;
+	bool background;
+	//Index of the newest input spectrum in the ring.
+	int current = 0;
+	//How much of the second half of window has arrived, and how much of output has been played.
+	int filled = 0, played = 0;
+	//window is the last fft_size samples of input.  compute reads task_input and writes task_output, so that the audio thread can keep going.
+	float* window, *task_input, *task_output, *output, *workspace;
+	float* line_real, *line_imag, *accumulator_real, *accumulator_imag;
+	//A stage's partitions are exactly what a PartitionedConvolver with blocks of partition_size uses, so they come from the same cache.
+	std::shared_ptr<PartitionedResponse> response;
+	std::shared_ptr<FftPlan> plan;
+	std::future<void> task;
+	bool task_pending = false;
+};
+
+NonUniformConvolverStage::NonUniformConvolverStage(int blockSize, int partitionSize, bool background, int length, float* response):
+block_size(blockSize), partition_size(partitionSize), background(background) {
+	fft_size = fftSizeAtLeast(2*partition_size);
+	plan = getFftPlan(fft_size);
+	bins = plan->getBinCount();
+	this->response = getPartitionedResponse(partition_size, length, response);
+	partition_count = this->response->getPartitionCount();
+	stride = (bins+3)/4*4;
+	window = allocArray<float>(fft_size);
+	task_input = allocArray<float>(fft_size);
+	task_output = allocArray<float>(partition_size);
+	output = allocArray<float>(partition_size);
+	workspace = allocArray<float>(fft_size);
+	line_real = allocArray<float>(stride*partition_count);
+	line_imag = allocArray<float>(stride*partition_count);
+	accumulator_real = allocArray<float>(stride);
+	accumulator_imag = allocArray<float>(stride);
+	reset();
+}
+
+NonUniformConvolverStage::~NonUniformConvolverStage() {
+	wait();
+	freeArray(window);
+	freeArray(task_input);
+	freeArray(task_output);
+	freeArray(output);
+	freeArray(workspace);
+	freeArray(line_real);
+	freeArray(line_imag);
+	freeArray(accumulator_real);
+	freeArray(accumulator_imag);
+}
+
+void NonUniformConvolverStage::convolve(float* input, float* out) {
+	additionKernel(block_size, output+played, out, out);
+	played += block_size;
+	std::copy(input, input+block_size, window+fft_size-partition_size+filled);
+	filled += block_size;
+	if(filled < partition_size) return;
+	if(background) {
+		//The deadline: the last partition's result starts playing next block.
+		wait();
+		std::swap(task_output, output);
+		std::copy(window, window+fft_size, task_input);
+		if(convolution_threads) {
+			task = convolution_threads->submitJobWithResult([this] () {compute();});
+			task_pending = true;
+		}
+		else compute();
+	}
+	else {
+		std::copy(window, window+fft_size, task_input);
+		compute();
+		std::swap(task_output, output);
+	}
+	played = 0;
+	filled = 0;
+	std::copy(window+partition_size, window+fft_size, window);
+}
+
+void NonUniformConvolverStage::compute() {
+	current = current == 0 ? partition_count-1 : current-1;
+	plan->forward(task_input, line_real+current*stride, line_imag+current*stride);
+	std::fill(accumulator_real, accumulator_real+bins, 0.0f);
+	std::fill(accumulator_imag, accumulator_imag+bins, 0.0f);
+	const float* responseReal = response->getReal(), *responseImag = response->getImag();
+	for(int p = 0; p < partition_count; p++) {
+		int slot = (current+p)%partition_count;
+		complexMultiplicationAdditionKernel(bins, line_real+slot*stride, line_imag+slot*stride, responseReal+p*stride, responseImag+p*stride, accumulator_real, accumulator_imag);
+	}
+	plan->inverse(accumulator_real, accumulator_imag, workspace);
+	std::copy(workspace+fft_size-partition_size, workspace+fft_size, task_output);
+}
+
+void NonUniformConvolverStage::wait() {
+	if(task_pending) task.wait();
+	task_pending = false;
+}
+
+void NonUniformConvolverStage::reset() {
+	wait();
+	std::fill(window, window+fft_size, 0.0f);
+	std::fill(task_output, task_output+partition_size, 0.0f);
+	std::fill(output, output+partition_size, 0.0f);
+	std::fill(line_real, line_real+stride*partition_count, 0.0f);
+	std::fill(line_imag, line_imag+stride*partition_count, 0.0f);
+	current = 0;
+	filled = 0;
+	played = 0;
+}
+
+NonUniformConvolver::NonUniformConvolver(int blockSize): block_size(blockSize), head(blockSize) {
+	float defaultResponse = 1;
+	setResponse(1, &defaultResponse);
+}
+
+NonUniformConvolver::~NonUniformConvolver() {
+	clearStages();
+}
+
+void NonUniformConvolver::clearStages() {
+	for(auto s: stages) delete s;
+	stages.clear();
+}
+
+void NonUniformConvolver::setResponse(int length, float* response) {
+	clearStages();
+	head.setResponse(std::min(length, block_size), response);
+	head.reset();
+	int offset = block_size, partition = block_size;
+	//Partitions must stay whole numbers of blocks.
+	int maxPartition = block_size;
+	while(2*maxPartition <= NONUNIFORM_CONVOLVER_MAX_PARTITION) maxPartition *= 2;
+	while(offset < length) {
+		int nextPartition = std::min(2*partition, maxPartition);
+		//A stage ends where the next one's partitions fit, twice the next partition size in; the last takes the rest.
+		int end = nextPartition > partition ? std::min(2*nextPartition, length) : length;
+		stages.push_back(new NonUniformConvolverStage(block_size, partition, partition > block_size, end-offset, response+offset));
+		offset = end;
+		partition = nextPartition;
+	}
+}
+
+void NonUniformConvolver::convolve(float* input, float* output) {
+	head.convolve(input, output);
+	for(auto s: stages) s->convolve(input, output);
+}
+
+void NonUniformConvolver::reset() {
+	head.reset();
+	for(auto s: stages) s->reset();
+}
+
+}
\ No newline at end of file
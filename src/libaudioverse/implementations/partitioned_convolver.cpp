@@ -0,0 +1,255 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/implementations/convolvers.hpp>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string.h>
+#include <stdint.h>
+
+namespace libaudioverse_implementation {
+
+int partitionedFftSize(int blockSize) {
+	return fftSizeAtLeast(2*blockSize);
+}
+
+//Padded so that every partition's spectrum is aligned.
+int partitionedStride(int blockSize) {
+	return (partitionedFftSize(blockSize)/2+1+3)/4*4;
+}
+
+PartitionedResponse::PartitionedResponse(int blockSize, int length, float* response): PartitionedResponse(blockSize, length) {
+	samples.assign(response, response+length);
+	int fftSize = partitionedFftSize(block_size), stride = partitionedStride(block_size);
+	auto plan = getFftPlan(fftSize);
+	float* workspace = allocArray<float>(fftSize);
+	//The inverse fft isn't normalized, so fold its scale into the response.
+	float scale = 1.0f/fftSize;
+	for(int p = 0; p < partition_count; p++) {
+		std::fill(workspace, workspace+fftSize, 0.0f);
+		int start = p*block_size, end = std::min(length, start+block_size);
+		if(end > start) scalarMultiplicationKernel(end-start, scale, response+start, workspace);
+		plan->forward(workspace, real+p*stride, imag+p*stride);
+	}
+	freeArray(workspace);
+}
+
+PartitionedResponse::PartitionedResponse(int blockSize, int length): block_size(blockSize) {
+	int stride = partitionedStride(block_size);
+	partition_count = std::max(1, (length+block_size-1)/block_size);
+	real = allocArray<float>(stride*partition_count);
+	imag = allocArray<float>(stride*partition_count);
+}
+
+PartitionedResponse::~PartitionedResponse() {
+	freeArray(real);
+	freeArray(imag);
+}
+
+bool PartitionedResponse::matches(int blockSize, int length, float* response) {
+	return blockSize == block_size && length == (int)samples.size() && (length == 0 || memcmp(response, &samples[0], sizeof(float)*length) == 0);
+}
+
+void PartitionedResponse::mix(int count, PartitionedResponse** sources, const float* weights) {
+	//The fft is linear, so this is the same as transforming the mixed samples.
+	int length = partitionedStride(block_size)*partition_count;
+	samples.clear();
+	std::fill(real, real+length, 0.0f);
+	std::fill(imag, imag+length, 0.0f);
+	for(int i = 0; i < count; i++) {
+		if(weights[i] == 0.0f) continue;
+		multiplicationAdditionKernel(length, weights[i], sources[i]->real, real, real);
+		multiplicationAdditionKernel(length, weights[i], sources[i]->imag, imag, imag);
+	}
+}
+
+int PartitionedResponse::getBlockSize() {
+	return block_size;
+}
+
+int PartitionedResponse::getPartitionCount() {
+	return partition_count;
+}
+
+const float* PartitionedResponse::getReal() {
+	return real;
+}
+
+const float* PartitionedResponse::getImag() {
+	return imag;
+}
+
+//Keyed by a hash of the block size and samples; matches settles collisions.
+std::multimap<uint64_t, std::weak_ptr<PartitionedResponse>> *partitioned_response_cache;
+std::mutex *partitioned_response_cache_mutex;
+
+void initializePartitionedResponseCache() {
+	partitioned_response_cache = new std::multimap<uint64_t, std::weak_ptr<PartitionedResponse>>();
+	partitioned_response_cache_mutex = new std::mutex();
+}
+
+void shutdownPartitionedResponseCache() {
+	delete partitioned_response_cache;
+	delete partitioned_response_cache_mutex;
+}
+
+uint64_t hashResponse(int blockSize, int length, float* response) {
+	//FNV-1a.
+	uint64_t hash = 14695981039346656037ULL;
+	auto mix = [&] (const unsigned char* bytes, std::size_t count) {
+		for(std::size_t i = 0; i < count; i++) hash = (hash^bytes[i])*1099511628211ULL;
+	};
+	mix((const unsigned char*)&blockSize, sizeof(blockSize));
+	mix((const unsigned char*)response, sizeof(float)*length);
+	return hash;
+}
+
+std::shared_ptr<PartitionedResponse> getPartitionedResponse(int blockSize, int length, float* response) {
+	uint64_t hash = hashResponse(blockSize, length, response);
+	std::lock_guard<std::mutex> guard(*partitioned_response_cache_mutex);
+	auto range = partitioned_response_cache->equal_range(hash);
+	for(auto i = range.first; i != range.second; i++) {
+		auto r = i->second.lock();
+		if(r && r->matches(blockSize, length, response)) return r;
+	}
+	//Forget responses nobody uses anymore before adding this one.
+	for(auto i = partitioned_response_cache->begin(); i != partitioned_response_cache->end();) {
+		if(i->second.expired()) i = partitioned_response_cache->erase(i);
+		else i++;
+	}
+	auto r = std::make_shared<PartitionedResponse>(blockSize, length, response);
+	partitioned_response_cache->emplace(hash, r);
+	return r;
+}
+
+PartitionedConvolver::PartitionedConvolver(int blockSize, int responseCount): block_size(blockSize) {
+	fft_size = partitionedFftSize(block_size);
+	plan = getFftPlan(fft_size);
+	bins = plan->getBinCount();
+	stride = partitionedStride(block_size);
+	input_history = allocArray<float>(fft_size);
+	workspace = allocArray<float>(fft_size);
+	crossfade_workspace = allocArray<float>(block_size);
+	accumulator_real = allocArray<float>(stride);
+	accumulator_imag = allocArray<float>(stride);
+	responseCount = std::max(1, responseCount);
+	responses.resize(responseCount);
+	previous_responses.resize(responseCount);
+	crossfading.resize(responseCount, false);
+	float defaultResponse = 1;
+	for(int i = 0; i < responseCount; i++) setResponse(i, 1, &defaultResponse);
+}
+
+PartitionedConvolver::~PartitionedConvolver() {
+	freeArrays();
+	freeArray(input_history);
+	freeArray(workspace);
+	freeArray(crossfade_workspace);
+	freeArray(accumulator_real);
+	freeArray(accumulator_imag);
+}
+
+void PartitionedConvolver::freeArrays() {
+	if(line_real) freeArray(line_real);
+	if(line_imag) freeArray(line_imag);
+}
+
+void PartitionedConvolver::resizeRing(int count) {
+	float* newReal = allocArray<float>(stride*count), *newImag = allocArray<float>(stride*count);
+	//Slot p of the new ring is the input from p blocks ago.
+	for(int p = 0; p < std::min(count, partition_count); p++) {
+		int slot = (current+p)%partition_count;
+		std::copy(line_real+slot*stride, line_real+(slot+1)*stride, newReal+p*stride);
+		std::copy(line_imag+slot*stride, line_imag+(slot+1)*stride, newImag+p*stride);
+	}
+	freeArrays();
+	line_real = newReal;
+	line_imag = newImag;
+	partition_count = count;
+	current = 0;
+}
+
+void PartitionedConvolver::setResponse(int length, float* response) {
+	setResponse(0, length, response);
+}
+
+void PartitionedConvolver::setResponse(int index, int length, float* response) {
+	setResponse(index, getPartitionedResponse(block_size, length, response));
+}
+
+void PartitionedConvolver::setResponse(int index, std::shared_ptr<PartitionedResponse> response, bool crossfade, std::vector<std::shared_ptr<PartitionedResponse>>* displaced) {
+	//Only fade from something that was playing.
+	crossfade = crossfade && responses[index] != nullptr;
+	if(displaced) {
+		displaced->push_back(previous_responses[index]);
+		if(crossfade == false) displaced->push_back(responses[index]);
+	}
+	previous_responses[index] = crossfade ? responses[index] : nullptr;
+	crossfading[index] = crossfade;
+	responses[index] = response;
+	//The ring holds enough input for the longest response, including any being faded out, and skipping any not yet set.
+	int newPartitionCount = 1;
+	for(auto &r: responses) if(r) newPartitionCount = std::max(newPartitionCount, r->getPartitionCount());
+	for(auto &r: previous_responses) if(r) newPartitionCount = std::max(newPartitionCount, r->getPartitionCount());
+	if(newPartitionCount != partition_count) resizeRing(newPartitionCount);
+}
+
+void PartitionedConvolver::convolve(float* input, float* output) {
+	convolve(input, &output);
+}
+
+void PartitionedConvolver::convolve(float* input, float** outputs) {
+	//Overlap-save: transform this block along with the ones before it.
+	std::copy(input_history+block_size, input_history+fft_size, input_history);
+	std::copy(input, input+block_size, input_history+fft_size-block_size);
+	current = current == 0 ? partition_count-1 : current-1;
+	plan->forward(input_history, line_real+current*stride, line_imag+current*stride);
+	for(int r = 0; r < (int)responses.size(); r++) {
+		convolveResponse(responses[r].get(), outputs[r]);
+		if(crossfading[r]) {
+			convolveResponse(previous_responses[r].get(), crossfade_workspace);
+			crossfadeKernel(block_size, 0.0f, 1.0f/block_size, crossfade_workspace, outputs[r], outputs[r]);
+			crossfading[r] = false;
+		}
+	}
+}
+
+void PartitionedConvolver::convolveResponse(PartitionedResponse* response, float* output) {
+	const float* responseReal = response->getReal(), *responseImag = response->getImag();
+	//Partition p goes with the input from p blocks ago.
+	std::fill(accumulator_real, accumulator_real+bins, 0.0f);
+	std::fill(accumulator_imag, accumulator_imag+bins, 0.0f);
+	for(int p = 0; p < response->getPartitionCount(); p++) {
+		int slot = (current+p)%partition_count;
+		complexMultiplicationAdditionKernel(bins, line_real+slot*stride, line_imag+slot*stride, responseReal+p*stride, responseImag+p*stride, accumulator_real, accumulator_imag);
+	}
+	plan->inverse(accumulator_real, accumulator_imag, workspace);
+	//Everything before the last block wrapped around.
+	std::copy(workspace+fft_size-block_size, workspace+fft_size, output);
+}
+
+void PartitionedConvolver::reset() {
+	std::fill(input_history, input_history+fft_size, 0.0f);
+	std::fill(line_real, line_real+stride*partition_count, 0.0f);
+	std::fill(line_imag, line_imag+stride*partition_count, 0.0f);
+	current = 0;
+	std::fill(crossfading.begin(), crossfading.end(), false);
+}
+
+int PartitionedConvolver::getPartitionCount() {
+	return partition_count;
+}
+
+int PartitionedConvolver::getResponseCount() {
+	return (int)responses.size();
+}
+
+}
\ No newline at end of file
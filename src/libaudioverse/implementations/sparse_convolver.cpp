@@ -0,0 +1,100 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <libaudioverse/private/macros.hpp>
+#include <libaudioverse/libaudioverse.h>
+#include <libaudioverse/implementations/convolvers.hpp>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <math.h>
+
+namespace libaudioverse_implementation {
+
+int countSparseTaps(int length, float* response, float threshold) {
+	int count = 0;
+	for(int i = 0; i < length; i++) if(fabsf(response[i]) > threshold) count++;
+	return count;
+}
+
+SparseConvolver::SparseConvolver(int blockSize): block_size(blockSize) {
+	float defaultResponse = 1.0f;
+	setResponse(1, &defaultResponse);
+}
+
+SparseConvolver::~SparseConvolver() {
+	if(history) freeArray(history);
+}
+
+void SparseConvolver::setResponse(int length, float* response, float threshold) {
+	std::vector<int> newDelays;
+	std::vector<float> newGains;
+	for(int i = 0; i < length; i++) {
+		if(fabsf(response[i]) <= threshold) continue;
+		newDelays.push_back(i);
+		newGains.push_back(response[i]);
+	}
+	delays = newDelays;
+	gains = newGains;
+	resizeRing(delays.size() ? delays.back() : 0);
+}
+
+void SparseConvolver::setTaps(int count, int* newDelays, float* newGains) {
+	for(int i = 0; i < count; i++) if(newDelays[i] < 0) ERROR(Lav_ERROR_RANGE, "Tap delays must not be negative.");
+	std::vector<int> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&] (int a, int b) {return newDelays[a] < newDelays[b];});
+	delays.clear();
+	gains.clear();
+	for(int i: order) {
+		//Taps with the same delay are summed, so that each costs one pass over the block.
+		if(delays.size() && delays.back() == newDelays[i]) gains.back() += newGains[i];
+		else {
+			delays.push_back(newDelays[i]);
+			gains.push_back(newGains[i]);
+		}
+	}
+	resizeRing(delays.size() ? delays.back() : 0);
+}
+
+void SparseConvolver::resizeRing(int maxDelay) {
+	//The current block and maxDelay samples before it.
+	int newCapacity = block_size+maxDelay;
+	if(history && newCapacity == capacity) return;
+	if(history) freeArray(history);
+	history = allocArray<float>(2*newCapacity);
+	capacity = newCapacity;
+	position = 0;
+}
+
+void SparseConvolver::convolve(float* input, float* output) {
+	int first = std::min(block_size, capacity-position);
+	std::copy(input, input+first, history+position);
+	std::copy(input, input+first, history+position+capacity);
+	std::copy(input+first, input+block_size, history);
+	std::copy(input+first, input+block_size, history+capacity);
+	std::fill(output, output+block_size, 0.0f);
+	for(int i = 0; i < (int)delays.size(); i++) {
+		//Where the block delayed by this tap starts; the second copy makes the next block_size samples contiguous.
+		int start = position-delays[i];
+		if(start < 0) start += capacity;
+		multiplicationAdditionKernel(block_size, gains[i], history+start, output, output);
+	}
+	position = (position+block_size)%capacity;
+}
+
+void SparseConvolver::reset() {
+	std::fill(history, history+2*capacity, 0.0f);
+	position = 0;
+}
+
+int SparseConvolver::getTapCount() {
+	return (int)delays.size();
+}
+
+}
\ No newline at end of file
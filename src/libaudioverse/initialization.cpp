@@ -14,6 +14,9 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/audio_devices.hpp>
 #include <libaudioverse/private/logging.hpp>
 #include <libaudioverse/private/hrtf.hpp>
+#include <libaudioverse/private/wavetables.hpp>
+#include <libaudioverse/private/fft.hpp>
+#include <libaudioverse/implementations/convolvers.hpp>
 
 namespace libaudioverse_implementation {
 
@@ -36,6 +39,12 @@ InitInfo initializers[] = {
 	{"Audio backend", initializeDeviceFactory},
 	{"Metadata tables", initializeMetadata},
 	{"HRTF caches", initializeHrtfCaches},
+	{"Wavetable caches", initializeWavetableCaches},
+	{"FFT plan cache", initializeFftPlanCache},
+	{"Partitioned response cache", initializePartitionedResponseCache},
+	{"Convolution threads", initializeConvolutionThreads},
+	//After the fft plan cache, which it measures.
+	{"Convolution cost model", calibrateConvolutionCosts},
 };
 
 typedef void (*shutdownfunc_t)();
@@ -53,9 +62,14 @@ struct ShutdownInfo{
 ShutdownInfo shutdown_funcs[] = {
 	{"Error handling subsystem", shutdownErrorModule},
 	{"memory module", shutdownMemoryModule},
+	//After the memory module, so that nodes it destroys can still wait on their background work.
+	{"convolution threads", shutdownConvolutionThreads},
 	//Device factory needs to go near the end because it tries to log.
 	{"audio backend", shutdownDeviceFactory},
 	{"HRTF caches", shutdownHrtfCaches},
+	{"wavetable caches", shutdownWavetableCaches},
+	{"FFT plan cache", shutdownFftPlanCache},
+	{"partitioned response cache", shutdownPartitionedResponseCache},
 	{"logging", shutdownLogging},
 };
 
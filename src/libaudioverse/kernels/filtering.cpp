@@ -0,0 +1,378 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+
+/**Implements the multichannel filtering kernels, which run one channel per SIMD lane.*/
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <mmintrin.h>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#include <algorithm>
+
+namespace libaudioverse_implementation {
+
+//These must match the tick functions of the filters exactly, including the order of operations.
+void biquadLanesKernelSimple(int lanes, int length, float** inputs, float** outputs, const double* coefficients, double* history) {
+	for(int lane = 0; lane < lanes; lane++) {
+		double b0 = coefficients[lane], b1 = coefficients[4+lane], b2 = coefficients[8+lane];
+		double a1 = coefficients[12+lane], a2 = coefficients[16+lane];
+		double h1 = history[lane], h2 = history[4+lane];
+		for(int i = 0; i < length; i++) {
+			double recursive = inputs[lane][i]-a1*h1-a2*h2;
+			outputs[lane][i] = (float)(b0*recursive+b1*h1+b2*h2);
+			h2 = h1;
+			h1 = recursive;
+		}
+		history[lane] = h1;
+		history[4+lane] = h2;
+	}
+}
+
+//offset is where in the ramp the first sample is, so that the SSE version can hand off its tail.
+void biquadRampLanesKernelSimple(int lanes, int length, float** inputs, float** outputs, const double* start, const double* delta, double* history, int offset = 0) {
+	for(int lane = 0; lane < lanes; lane++) {
+		double h1 = history[lane], h2 = history[4+lane];
+		for(int i = 0; i < length; i++) {
+			int n = offset+i+1;
+			double b0 = start[0]+n*delta[0], b1 = start[1]+n*delta[1], b2 = start[2]+n*delta[2];
+			double a1 = start[3]+n*delta[3], a2 = start[4]+n*delta[4];
+			double recursive = inputs[lane][i]-a1*h1-a2*h2;
+			outputs[lane][i] = (float)(b0*recursive+b1*h1+b2*h2);
+			h2 = h1;
+			h1 = recursive;
+		}
+		history[lane] = h1;
+		history[4+lane] = h2;
+	}
+}
+
+void onePoleLanesKernelSimple(int lanes, int length, float** inputs, float** outputs, const float* coefficients, float* history) {
+	for(int lane = 0; lane < lanes; lane++) {
+		float b0 = coefficients[lane], a1 = coefficients[4+lane];
+		float last = history[lane];
+		for(int i = 0; i < length; i++) {
+			last = b0*inputs[lane][i]-a1*last;
+			outputs[lane][i] = last;
+		}
+		history[lane] = last;
+	}
+}
+
+void firstOrderLanesKernelSimple(int lanes, int length, float** inputs, float** outputs, const float* coefficients, float* history) {
+	for(int lane = 0; lane < lanes; lane++) {
+		float b0 = coefficients[lane], b1 = coefficients[4+lane], a1 = coefficients[8+lane];
+		float lastInput = history[lane], lastOutput = history[4+lane];
+		for(int i = 0; i < length; i++) {
+			float input = inputs[lane][i];
+			lastOutput = b0*input+b1*lastInput-a1*lastOutput;
+			lastInput = input;
+			outputs[lane][i] = lastOutput;
+		}
+		history[lane] = lastInput;
+		history[4+lane] = lastOutput;
+	}
+}
+
+void sineLanesKernelSimple(int lanes, int length, float** outputs, double* state) {
+	for(int lane = 0; lane < lanes; lane++) {
+		double sx = state[lane], cx = state[4+lane], sd = state[8+lane], cd = state[12+lane];
+		for(int i = 0; i < length; i++) {
+			outputs[lane][i] = (float)sx;
+			double osx = sx, ocx = cx;
+			sx = osx*cd+ocx*sd;
+			cx = ocx*cd-osx*sd;
+		}
+		state[lane] = sx;
+		state[4+lane] = cx;
+	}
+}
+
+void biquadCascadeKernelSimple(int sections, int length, float* input, float* output, const double* coefficients, double* history) {
+	for(int i = 0; i < length; i++) {
+		double sample = input[i];
+		for(int s = 0; s < sections; s++) {
+			const double* c = coefficients+s*5;
+			double* h = history+s*2;
+			double recursive = sample-c[3]*h[0]-c[4]*h[1];
+			sample = c[0]*recursive+c[1]*h[0]+c[2]*h[1];
+			h[1] = h[0];
+			h[0] = recursive;
+		}
+		output[i] = (float)sample;
+	}
+}
+
+#if defined(LIBAUDIOVERSE_USE_SSE2)
+
+//Reads 4 samples from every lane and transposes them, so that samples[j] holds sample i+j of all lanes.
+//Missing lanes read as zero.
+static inline void loadLanes(int lanes, float** inputs, int i, __m128* samples) {
+	for(int lane = 0; lane < 4; lane++) samples[lane] = lane < lanes ? _mm_loadu_ps(inputs[lane]+i) : _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(samples[0], samples[1], samples[2], samples[3]);
+}
+
+//The inverse of loadLanes.  Missing lanes are dropped.
+static inline void storeLanes(int lanes, float** outputs, int i, __m128* samples) {
+	_MM_TRANSPOSE4_PS(samples[0], samples[1], samples[2], samples[3]);
+	for(int lane = 0; lane < lanes; lane++) _mm_storeu_ps(outputs[lane]+i, samples[lane]);
+}
+
+//Pointers to the tail of every lane, for handing the leftover samples to the simple kernels.
+static inline void offsetLanes(int lanes, float** pointers, int offset, float** dest) {
+	for(int lane = 0; lane < lanes; lane++) dest[lane] = pointers[lane]+offset;
+}
+
+void biquadLanesKernel(int lanes, int length, float** inputs, float** outputs, const double* coefficients, double* history) {
+	//SSE2 holds 2 doubles, so each set of 4 lanes is split into a low and high half.
+	//Unused lanes have all-zero coefficients and so output silence.
+	double c[20] = {0.0}, h[8] = {0.0};
+	for(int k = 0; k < 5; k++) for(int lane = 0; lane < lanes; lane++) c[k*4+lane] = coefficients[k*4+lane];
+	for(int k = 0; k < 2; k++) for(int lane = 0; lane < lanes; lane++) h[k*4+lane] = history[k*4+lane];
+	__m128d b0l = _mm_loadu_pd(c), b0h = _mm_loadu_pd(c+2);
+	__m128d b1l = _mm_loadu_pd(c+4), b1h = _mm_loadu_pd(c+6);
+	__m128d b2l = _mm_loadu_pd(c+8), b2h = _mm_loadu_pd(c+10);
+	__m128d a1l = _mm_loadu_pd(c+12), a1h = _mm_loadu_pd(c+14);
+	__m128d a2l = _mm_loadu_pd(c+16), a2h = _mm_loadu_pd(c+18);
+	__m128d h1l = _mm_loadu_pd(h), h1h = _mm_loadu_pd(h+2);
+	__m128d h2l = _mm_loadu_pd(h+4), h2h = _mm_loadu_pd(h+6);
+	int neededLength = length/4*4;
+	__m128 samples[4];
+	for(int i = 0; i < neededLength; i += 4) {
+		loadLanes(lanes, inputs, i, samples);
+		for(int j = 0; j < 4; j++) {
+			__m128d xl = _mm_cvtps_pd(samples[j]), xh = _mm_cvtps_pd(_mm_movehl_ps(samples[j], samples[j]));
+			__m128d rl = _mm_sub_pd(_mm_sub_pd(xl, _mm_mul_pd(a1l, h1l)), _mm_mul_pd(a2l, h2l));
+			__m128d rh = _mm_sub_pd(_mm_sub_pd(xh, _mm_mul_pd(a1h, h1h)), _mm_mul_pd(a2h, h2h));
+			__m128d ol = _mm_add_pd(_mm_add_pd(_mm_mul_pd(b0l, rl), _mm_mul_pd(b1l, h1l)), _mm_mul_pd(b2l, h2l));
+			__m128d oh = _mm_add_pd(_mm_add_pd(_mm_mul_pd(b0h, rh), _mm_mul_pd(b1h, h1h)), _mm_mul_pd(b2h, h2h));
+			h2l = h1l;
+			h2h = h1h;
+			h1l = rl;
+			h1h = rh;
+			samples[j] = _mm_movelh_ps(_mm_cvtpd_ps(ol), _mm_cvtpd_ps(oh));
+		}
+		storeLanes(lanes, outputs, i, samples);
+	}
+	_mm_storeu_pd(h, h1l);
+	_mm_storeu_pd(h+2, h1h);
+	_mm_storeu_pd(h+4, h2l);
+	_mm_storeu_pd(h+6, h2h);
+	for(int k = 0; k < 2; k++) for(int lane = 0; lane < lanes; lane++) history[k*4+lane] = h[k*4+lane];
+	float* inputTails[4], *outputTails[4];
+	offsetLanes(lanes, inputs, neededLength, inputTails);
+	offsetLanes(lanes, outputs, neededLength, outputTails);
+	biquadLanesKernelSimple(lanes, length-neededLength, inputTails, outputTails, coefficients, history);
+}
+
+void biquadRampLanesKernel(int lanes, int length, float** inputs, float** outputs, const double* start, const double* delta, double* history) {
+	double h[8] = {0.0};
+	for(int k = 0; k < 2; k++) for(int lane = 0; lane < lanes; lane++) h[k*4+lane] = history[k*4+lane];
+	__m128d h1l = _mm_loadu_pd(h), h1h = _mm_loadu_pd(h+2);
+	__m128d h2l = _mm_loadu_pd(h+4), h2h = _mm_loadu_pd(h+6);
+	int neededLength = length/4*4;
+	__m128 samples[4];
+	for(int i = 0; i < neededLength; i += 4) {
+		loadLanes(lanes, inputs, i, samples);
+		for(int j = 0; j < 4; j++) {
+			int n = i+j+1;
+			__m128d b0 = _mm_set1_pd(start[0]+n*delta[0]), b1 = _mm_set1_pd(start[1]+n*delta[1]), b2 = _mm_set1_pd(start[2]+n*delta[2]);
+			__m128d a1 = _mm_set1_pd(start[3]+n*delta[3]), a2 = _mm_set1_pd(start[4]+n*delta[4]);
+			__m128d xl = _mm_cvtps_pd(samples[j]), xh = _mm_cvtps_pd(_mm_movehl_ps(samples[j], samples[j]));
+			__m128d rl = _mm_sub_pd(_mm_sub_pd(xl, _mm_mul_pd(a1, h1l)), _mm_mul_pd(a2, h2l));
+			__m128d rh = _mm_sub_pd(_mm_sub_pd(xh, _mm_mul_pd(a1, h1h)), _mm_mul_pd(a2, h2h));
+			__m128d ol = _mm_add_pd(_mm_add_pd(_mm_mul_pd(b0, rl), _mm_mul_pd(b1, h1l)), _mm_mul_pd(b2, h2l));
+			__m128d oh = _mm_add_pd(_mm_add_pd(_mm_mul_pd(b0, rh), _mm_mul_pd(b1, h1h)), _mm_mul_pd(b2, h2h));
+			h2l = h1l;
+			h2h = h1h;
+			h1l = rl;
+			h1h = rh;
+			samples[j] = _mm_movelh_ps(_mm_cvtpd_ps(ol), _mm_cvtpd_ps(oh));
+		}
+		storeLanes(lanes, outputs, i, samples);
+	}
+	_mm_storeu_pd(h, h1l);
+	_mm_storeu_pd(h+2, h1h);
+	_mm_storeu_pd(h+4, h2l);
+	_mm_storeu_pd(h+6, h2h);
+	for(int k = 0; k < 2; k++) for(int lane = 0; lane < lanes; lane++) history[k*4+lane] = h[k*4+lane];
+	float* inputTails[4], *outputTails[4];
+	offsetLanes(lanes, inputs, neededLength, inputTails);
+	offsetLanes(lanes, outputs, neededLength, outputTails);
+	biquadRampLanesKernelSimple(lanes, length-neededLength, inputTails, outputTails, start, delta, history, neededLength);
+}
+
+void onePoleLanesKernel(int lanes, int length, float** inputs, float** outputs, const float* coefficients, float* history) {
+	float c[8] = {0.0f}, h[4] = {0.0f};
+	for(int k = 0; k < 2; k++) for(int lane = 0; lane < lanes; lane++) c[k*4+lane] = coefficients[k*4+lane];
+	for(int lane = 0; lane < lanes; lane++) h[lane] = history[lane];
+	__m128 b0 = _mm_loadu_ps(c), a1 = _mm_loadu_ps(c+4);
+	__m128 last = _mm_loadu_ps(h);
+	int neededLength = length/4*4;
+	__m128 samples[4];
+	for(int i = 0; i < neededLength; i += 4) {
+		loadLanes(lanes, inputs, i, samples);
+		for(int j = 0; j < 4; j++) {
+			last = _mm_sub_ps(_mm_mul_ps(b0, samples[j]), _mm_mul_ps(a1, last));
+			samples[j] = last;
+		}
+		storeLanes(lanes, outputs, i, samples);
+	}
+	_mm_storeu_ps(h, last);
+	for(int lane = 0; lane < lanes; lane++) history[lane] = h[lane];
+	float* inputTails[4], *outputTails[4];
+	offsetLanes(lanes, inputs, neededLength, inputTails);
+	offsetLanes(lanes, outputs, neededLength, outputTails);
+	onePoleLanesKernelSimple(lanes, length-neededLength, inputTails, outputTails, coefficients, history);
+}
+
+void firstOrderLanesKernel(int lanes, int length, float** inputs, float** outputs, const float* coefficients, float* history) {
+	float c[12] = {0.0f}, h[8] = {0.0f};
+	for(int k = 0; k < 3; k++) for(int lane = 0; lane < lanes; lane++) c[k*4+lane] = coefficients[k*4+lane];
+	for(int k = 0; k < 2; k++) for(int lane = 0; lane < lanes; lane++) h[k*4+lane] = history[k*4+lane];
+	__m128 b0 = _mm_loadu_ps(c), b1 = _mm_loadu_ps(c+4), a1 = _mm_loadu_ps(c+8);
+	__m128 lastInput = _mm_loadu_ps(h), lastOutput = _mm_loadu_ps(h+4);
+	int neededLength = length/4*4;
+	__m128 samples[4];
+	for(int i = 0; i < neededLength; i += 4) {
+		loadLanes(lanes, inputs, i, samples);
+		for(int j = 0; j < 4; j++) {
+			lastOutput = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(b0, samples[j]), _mm_mul_ps(b1, lastInput)), _mm_mul_ps(a1, lastOutput));
+			lastInput = samples[j];
+			samples[j] = lastOutput;
+		}
+		storeLanes(lanes, outputs, i, samples);
+	}
+	_mm_storeu_ps(h, lastInput);
+	_mm_storeu_ps(h+4, lastOutput);
+	for(int k = 0; k < 2; k++) for(int lane = 0; lane < lanes; lane++) history[k*4+lane] = h[k*4+lane];
+	float* inputTails[4], *outputTails[4];
+	offsetLanes(lanes, inputs, neededLength, inputTails);
+	offsetLanes(lanes, outputs, neededLength, outputTails);
+	firstOrderLanesKernelSimple(lanes, length-neededLength, inputTails, outputTails, coefficients, history);
+}
+
+//One direct form 2 step for 2 sections at once.
+static inline __m128d biquadStep2(__m128d x, const __m128d* c, __m128d &h1, __m128d &h2) {
+	__m128d recursive = _mm_sub_pd(_mm_sub_pd(x, _mm_mul_pd(c[3], h1)), _mm_mul_pd(c[4], h2));
+	__m128d y = _mm_add_pd(_mm_add_pd(_mm_mul_pd(c[0], recursive), _mm_mul_pd(c[1], h1)), _mm_mul_pd(c[2], h2));
+	h2 = h1;
+	h1 = recursive;
+	return y;
+}
+
+//The cascade works on chunks in this double precision workspace, so that nothing is rounded to float between sections.
+const int cascade_chunk = 64;
+
+void biquadCascadeKernel(int sections, int length, float* input, float* output, const double* coefficients, double* history) {
+	double chunk[cascade_chunk];
+	for(int start = 0; start < length; start += cascade_chunk) {
+		int count = std::min(cascade_chunk, length-start);
+		for(int i = 0; i < count; i++) chunk[i] = input[start+i];
+		//Sections go in pairs, with the second lane one sample behind the first so that it can take the first's output from the previous step.
+		int s = 0;
+		for(; s+1 < sections; s += 2) {
+			const double* c0 = coefficients+s*5, *c1 = coefficients+s*5+5;
+			__m128d c[5];
+			for(int k = 0; k < 5; k++) c[k] = _mm_setr_pd(c0[k], c1[k]);
+			double* h = history+s*2;
+			__m128d h1 = _mm_setr_pd(h[0], h[2]), h2 = _mm_setr_pd(h[1], h[3]);
+			//Prime: only the first lane runs, so the second lane's history must survive.
+			__m128d old1 = h1, old2 = h2;
+			__m128d y = biquadStep2(_mm_set_sd(chunk[0]), c, h1, h2);
+			h1 = _mm_move_sd(old1, h1);
+			h2 = _mm_move_sd(old2, h2);
+			for(int i = 1; i < count; i++) {
+				//Low lane gets sample i, high lane gets the low lane's output for sample i-1.
+				y = biquadStep2(_mm_shuffle_pd(_mm_set_sd(chunk[i]), y, 0), c, h1, h2);
+				_mm_storeh_pd(chunk+i-1, y);
+			}
+			//Drain: only the second lane runs.
+			old1 = h1;
+			old2 = h2;
+			y = biquadStep2(_mm_unpacklo_pd(_mm_setzero_pd(), y), c, h1, h2);
+			h1 = _mm_move_sd(h1, old1);
+			h2 = _mm_move_sd(h2, old2);
+			_mm_storeh_pd(chunk+count-1, y);
+			_mm_storel_pd(h, h1);
+			_mm_storeh_pd(h+2, h1);
+			_mm_storel_pd(h+1, h2);
+			_mm_storeh_pd(h+3, h2);
+		}
+		if(s < sections) {
+			const double* c = coefficients+s*5;
+			double* h = history+s*2;
+			for(int i = 0; i < count; i++) {
+				double recursive = chunk[i]-c[3]*h[0]-c[4]*h[1];
+				chunk[i] = c[0]*recursive+c[1]*h[0]+c[2]*h[1];
+				h[1] = h[0];
+				h[0] = recursive;
+			}
+		}
+		for(int i = 0; i < count; i++) output[start+i] = (float)chunk[i];
+	}
+}
+
+void sineLanesKernel(int lanes, int length, float** outputs, double* state) {
+	double s[16] = {0.0};
+	for(int k = 0; k < 4; k++) for(int lane = 0; lane < lanes; lane++) s[k*4+lane] = state[k*4+lane];
+	__m128d sxl = _mm_loadu_pd(s), sxh = _mm_loadu_pd(s+2);
+	__m128d cxl = _mm_loadu_pd(s+4), cxh = _mm_loadu_pd(s+6);
+	__m128d sdl = _mm_loadu_pd(s+8), sdh = _mm_loadu_pd(s+10);
+	__m128d cdl = _mm_loadu_pd(s+12), cdh = _mm_loadu_pd(s+14);
+	int neededLength = length/4*4;
+	__m128 samples[4];
+	for(int i = 0; i < neededLength; i += 4) {
+		for(int j = 0; j < 4; j++) {
+			samples[j] = _mm_movelh_ps(_mm_cvtpd_ps(sxl), _mm_cvtpd_ps(sxh));
+			__m128d nsxl = _mm_add_pd(_mm_mul_pd(sxl, cdl), _mm_mul_pd(cxl, sdl));
+			__m128d nsxh = _mm_add_pd(_mm_mul_pd(sxh, cdh), _mm_mul_pd(cxh, sdh));
+			cxl = _mm_sub_pd(_mm_mul_pd(cxl, cdl), _mm_mul_pd(sxl, sdl));
+			cxh = _mm_sub_pd(_mm_mul_pd(cxh, cdh), _mm_mul_pd(sxh, sdh));
+			sxl = nsxl;
+			sxh = nsxh;
+		}
+		storeLanes(lanes, outputs, i, samples);
+	}
+	_mm_storeu_pd(s, sxl);
+	_mm_storeu_pd(s+2, sxh);
+	_mm_storeu_pd(s+4, cxl);
+	_mm_storeu_pd(s+6, cxh);
+	for(int k = 0; k < 2; k++) for(int lane = 0; lane < lanes; lane++) state[k*4+lane] = s[k*4+lane];
+	float* outputTails[4];
+	offsetLanes(lanes, outputs, neededLength, outputTails);
+	sineLanesKernelSimple(lanes, length-neededLength, outputTails, state);
+}
+
+#else
+
+void biquadRampLanesKernel(int lanes, int length, float** inputs, float** outputs, const double* start, const double* delta, double* history) {
+	biquadRampLanesKernelSimple(lanes, length, inputs, outputs, start, delta, history);
+}
+
+void sineLanesKernel(int lanes, int length, float** outputs, double* state) {
+	sineLanesKernelSimple(lanes, length, outputs, state);
+}
+
+void biquadLanesKernel(int lanes, int length, float** inputs, float** outputs, const double* coefficients, double* history) {
+	biquadLanesKernelSimple(lanes, length, inputs, outputs, coefficients, history);
+}
+
+void onePoleLanesKernel(int lanes, int length, float** inputs, float** outputs, const float* coefficients, float* history) {
+	onePoleLanesKernelSimple(lanes, length, inputs, outputs, coefficients, history);
+}
+
+void firstOrderLanesKernel(int lanes, int length, float** inputs, float** outputs, const float* coefficients, float* history) {
+	firstOrderLanesKernelSimple(lanes, length, inputs, outputs, coefficients, history);
+}
+
+void biquadCascadeKernel(int sections, int length, float* input, float* output, const double* coefficients, double* history) {
+	biquadCascadeKernelSimple(sections, length, input, output, coefficients, history);
+}
+
+#endif
+
+}
\ No newline at end of file
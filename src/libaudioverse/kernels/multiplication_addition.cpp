@@ -11,6 +11,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <mmintrin.h>
 #include <emmintrin.h>
 #include <xmmintrin.h>
+#include <algorithm>
 
 namespace libaudioverse_implementation {
 
@@ -26,6 +27,24 @@ void parallelMultiplicationAdditionKernelSimple(int length, float c1, float c2,
 	}
 }
 
+void complexMultiplicationAdditionKernelSimple(int length, const float* ar, const float* ai, const float* br, const float* bi, float* destr, float* desti) {
+	for(int i = 0; i < length; i++) {
+		destr[i] += ar[i]*br[i]-ai[i]*bi[i];
+		desti[i] += ar[i]*bi[i]+ai[i]*br[i];
+	}
+}
+
+void postprocessingKernelSimple(int channels, int length, float** buffers, const double* mul, float mulConstant, const double* add, float addConstant) {
+	for(int i = 0; i < length; i++) {
+		float m = mul ? (float)mul[i] : mulConstant, a = add ? (float)add[i] : addConstant;
+		for(int j = 0; j < channels; j++) buffers[j][i] = buffers[j][i]*m+a;
+	}
+}
+
+void crossfadeKernelSimple(int length, float weight, float delta, float* a1, float* a2, float* dest) {
+	for(int i = 0; i < length; i++) dest[i] = a1[i]+(a2[i]-a1[i])*(weight+i*delta);
+}
+
 #if defined(LIBAUDIOVERSE_USE_SSE2)
 
 void multiplicationAdditionKernel(int length, float c, float* a1, float* a2, float* dest) {
@@ -67,14 +86,75 @@ void parallelMultiplicationAdditionKernel(int length, float c1, float c2, float
 	parallelMultiplicationAdditionKernelSimple(length-needed, c1, c2, c3, c4, a1+needed, a2+needed, out+needed);
 }
 
+void complexMultiplicationAdditionKernel(int length, const float* ar, const float* ai, const float* br, const float* bi, float* destr, float* desti) {
+	int neededLength = length/4*4;
+	for(int i = 0; i < neededLength; i += 4) {
+		__m128 arr = _mm_loadu_ps(ar+i), air = _mm_loadu_ps(ai+i);
+		__m128 brr = _mm_loadu_ps(br+i), bir = _mm_loadu_ps(bi+i);
+		__m128 real = _mm_sub_ps(_mm_mul_ps(arr, brr), _mm_mul_ps(air, bir));
+		__m128 imag = _mm_add_ps(_mm_mul_ps(arr, bir), _mm_mul_ps(air, brr));
+		_mm_storeu_ps(destr+i, _mm_add_ps(_mm_loadu_ps(destr+i), real));
+		_mm_storeu_ps(desti+i, _mm_add_ps(_mm_loadu_ps(desti+i), imag));
+	}
+	complexMultiplicationAdditionKernelSimple(length-neededLength, ar+neededLength, ai+neededLength, br+neededLength, bi+neededLength, destr+neededLength, desti+neededLength);
+}
+
+//Reads 4 of the double values as floats.
+static inline __m128 loadValues(const double* values, int i, __m128 constant) {
+	if(values == nullptr) return constant;
+	return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(values+i)), _mm_cvtpd_ps(_mm_loadu_pd(values+i+2)));
+}
+
+void postprocessingKernel(int channels, int length, float** buffers, const double* mul, float mulConstant, const double* add, float addConstant) {
+	int neededLength = length/4*4;
+	__m128 mulConstantr = _mm_set1_ps(mulConstant), addConstantr = _mm_set1_ps(addConstant);
+	for(int i = 0; i < neededLength; i += 4) {
+		__m128 m = loadValues(mul, i, mulConstantr), a = loadValues(add, i, addConstantr);
+		for(int j = 0; j < channels; j++) _mm_storeu_ps(buffers[j]+i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(buffers[j]+i), m), a));
+	}
+	if(neededLength == length) return;
+	float* tails[8];
+	//Tails are at most 3 samples, so do them in chunks of 8 channels rather than allocating.
+	for(int j = 0; j < channels; j += 8) {
+		int count = std::min(8, channels-j);
+		for(int k = 0; k < count; k++) tails[k] = buffers[j+k]+neededLength;
+		postprocessingKernelSimple(count, length-neededLength, tails, mul ? mul+neededLength : nullptr, mulConstant, add ? add+neededLength : nullptr, addConstant);
+	}
+}
+
+void crossfadeKernel(int length, float weight, float delta, float* a1, float* a2, float* dest) {
+	int neededLength = length/4*4;
+	__m128 weights = _mm_setr_ps(weight, weight+delta, weight+2*delta, weight+3*delta);
+	__m128 step = _mm_set1_ps(4*delta);
+	for(int i = 0; i < neededLength; i += 4) {
+		__m128 a1r = _mm_loadu_ps(a1+i);
+		__m128 a2r = _mm_loadu_ps(a2+i);
+		_mm_storeu_ps(dest+i, _mm_add_ps(a1r, _mm_mul_ps(_mm_sub_ps(a2r, a1r), weights)));
+		weights = _mm_add_ps(weights, step);
+	}
+	crossfadeKernelSimple(length-neededLength, weight+neededLength*delta, delta, a1+neededLength, a2+neededLength, dest+neededLength);
+}
+
 #else
 
 void multiplicationAdditionKernel(int length, float c, float* a1, float* a2, float* dest) {
 	multiplicationAdditionKernelSimple(length, c, a1, a2, dest);
 }
 
+void complexMultiplicationAdditionKernel(int length, const float* ar, const float* ai, const float* br, const float* bi, float* destr, float* desti) {
+	complexMultiplicationAdditionKernelSimple(length, ar, ai, br, bi, destr, desti);
+}
+
+void postprocessingKernel(int channels, int length, float** buffers, const double* mul, float mulConstant, const double* add, float addConstant) {
+	postprocessingKernelSimple(channels, length, buffers, mul, mulConstant, add, addConstant);
+}
+
 void parallelMultiplicationAdditionKernel(int length, float c1, float c2, float c3, float c4, float* a1, float* a2, float* out) {
-	parallelMultiplicationKernelSimple(length, c1, c2, c3, c4, a1, a2, out);
+	parallelMultiplicationAdditionKernelSimple(length, c1, c2, c3, c4, a1, a2, out);
+}
+
+void crossfadeKernel(int length, float weight, float delta, float* a1, float* a2, float* dest) {
+	crossfadeKernelSimple(length, weight, delta, a1, a2, dest);
 }
 
 #endif
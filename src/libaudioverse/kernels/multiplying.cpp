@@ -22,6 +22,10 @@ void scalarMultiplicationKernelSimple(int length, float c, float* a1, float* des
 	for(int i = 0; i < length; i++) dest[i]=c*a1[i];
 }
 
+void rampMultiplicationKernelSimple(int length, float start, float delta, float* a1, float* dest) {
+	for(int i = 0; i < length; i++) dest[i]=(start+i*delta)*a1[i];
+}
+
 #if defined(LIBAUDIOVERSE_USE_SSE2)
 void multiplicationKernel(int length, float* a1, float* a2, float* dest) {
 	int neededLength = (length/4)*4;
@@ -47,6 +51,19 @@ void scalarMultiplicationKernel(int length, float c, float* a1, float* dest) {
 	scalarMultiplicationKernelSimple(length-neededLength, c, a1+neededLength, dest+neededLength);
 }
 
+void rampMultiplicationKernel(int length, float start, float delta, float* a1, float* dest) {
+	int neededLength = (length/4)*4;
+	//The index is exact in float, so computing the gain from it doesn't drift like summing deltas would.
+	__m128 indices = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), four = _mm_set1_ps(4.0f);
+	__m128 startr = _mm_set1_ps(start), deltar = _mm_set1_ps(delta);
+	for(int i = 0; i < neededLength; i+= 4) {
+		__m128 gains = _mm_add_ps(startr, _mm_mul_ps(indices, deltar));
+		_mm_storeu_ps(dest+i, _mm_mul_ps(_mm_loadu_ps(a1+i), gains));
+		indices = _mm_add_ps(indices, four);
+	}
+	rampMultiplicationKernelSimple(length-neededLength, start+neededLength*delta, delta, a1+neededLength, dest+neededLength);
+}
+
 #else
 void multiplicationKernel(int length, float* a1, float* a2, float* dest) {
 	multiplicationKernelSimple(length, a1, a2, dest);
@@ -56,6 +73,10 @@ void scalarMultiplicationKernel(int length, float c, float* a1, float*dest) {
 	scalarMultiplicationKernelSimple(length, c, a1, dest);
 }
 
+void rampMultiplicationKernel(int length, float start, float delta, float* a1, float* dest) {
+	rampMultiplicationKernelSimple(length, start, delta, a1, dest);
+}
+
 #endif
 
 }
\ No newline at end of file
@@ -18,6 +18,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/kernels.hpp>
 #include <libaudioverse/private/buffer.hpp>
 #include <libaudioverse/private/dependency_computation.hpp>
+#include <libaudioverse/private/workspace.hpp>
 #include <algorithm>
 #include <memory>
 #include <stdlib.h>
@@ -75,6 +76,7 @@ Node::Node(int type, std::shared_ptr<Server> server, unsigned int numInputBuffer
 	
 	//Block sizes never change:
 	block_size = server->getBlockSize();
+	block_kernels = server->getBlockKernels();
 	
 	//We must invalidate the plan when people touch the state property.
 	getProperty(Lav_NODE_STATE).setPostChangedCallback([&] () {stateChanged();});
@@ -97,9 +99,15 @@ void Node::tickProperties() {
 }
 
 void Node::tick() {
+	if(beginTick() == false) return;
+	process();
+	endTick();
+}
+
+bool Node::beginTick() {
 	last_processed = server->getTickCount();
 	bool paused = getState() == Lav_NODESTATE_PAUSED;
-	if(paused) return;
+	if(paused) return false;
 	//If we're paused, then OutputConnectiona dds zeros.
 	//Consequently, we don't do this in that case.
 	if(should_zero_output_buffers) 	zeroOutputBuffers();
@@ -114,42 +122,33 @@ void Node::tick() {
 	is_processing = true;
 	num_input_buffers = input_buffers.size();
 	num_output_buffers = output_buffers.size();
-	process();
-	applyMul();
-	applyAdd();
-	is_processing = false;
+	return true;
 }
 
-void Node::applyMul() {
-	auto &mulProp = getProperty(Lav_NODE_MUL);
-	float** outputs =getOutputBufferArray();
-	if(mulProp.needsARate()) {
-		for(int i = 0; i < block_size; i++) {
-			float mul = mulProp.getFloatValue(i);
-			for(int j = 0; j < getOutputBufferCount(); j++) outputs[j][i]*=mul;
-		}
-	}
-	else if(mulProp.getFloatValue() !=1.0) {
-		for(int i = 0; i < getOutputBufferCount(); i++) {
-			scalarMultiplicationKernel(block_size, mulProp.getFloatValue(), outputs[i], outputs[i]);
-		}
-	}
+void Node::endTick() {
+	applyMulAdd();
+	is_processing = false;
 }
 
-void Node::applyAdd() {
+void Node::applyMulAdd() {
+	auto &mulProp = getProperty(Lav_NODE_MUL);
 	auto &addProp = getProperty(Lav_NODE_ADD);
 	float** outputs = getOutputBufferArray();
-	if(addProp.needsARate()) {
-		for(int i = 0; i < block_size; i++) {
-		float add=addProp.getFloatValue(i);
-			for(int j = 0; j < getOutputBufferCount(); j++) outputs[j][i]+=add;
+	int outputCount = getOutputBufferCount();
+	bool mulARate = mulProp.needsARate(), addARate = addProp.needsARate();
+	float mul = mulProp.getFloatValue(), add = addProp.getFloatValue();
+	if(mulARate == false && addARate == false) {
+		//One constant alone is a single pass anyway, and the block kernels do it fastest.
+		if(add == 0.0f) {
+			if(mul != 1.0f) for(int i = 0; i < outputCount; i++) block_kernels->scalarMultiplication(block_size, mul, outputs[i], outputs[i]);
+			return;
 		}
-	}
-	else if(addProp.getFloatValue() !=0.0) {
-		for(int i = 0; i < getOutputBufferCount(); i++) {
-			scalarAdditionKernel(block_size, addProp.getFloatValue(), outputs[i], outputs[i]);
+		if(mul == 1.0f) {
+			for(int i = 0; i < outputCount; i++) block_kernels->scalarAddition(block_size, add, outputs[i], outputs[i]);
+			return;
 		}
 	}
+	postprocessingKernel(outputCount, block_size, outputs, mulARate ? mulProp.getValueBuffer() : nullptr, mul, addARate ? addProp.getValueBuffer() : nullptr, add);
 }
 
 //cleans up stuff.
@@ -161,6 +160,10 @@ void Node::doMaintenance() {
 void Node::process() {
 }
 
+void Node::processBatch(int count, Node** nodes) {
+	for(int i = 0; i < count; i++) nodes[i]->process();
+}
+
 void Node::zeroOutputBuffers() {
 	float** outputBuffers=getOutputBufferArray();
 	int outputBufferCount = getOutputBufferCount();
@@ -376,6 +379,20 @@ void Node::execute() {
 	tick();
 }
 
+thread_local Workspace<Node*> batch_workspace;
+
+void Node::executeBatch(int count, std::shared_ptr<Job>* jobs) {
+	Node** nodes = batch_workspace.get(count, false);
+	int active = 0;
+	//Gathering every input before processing any is only safe because the planner never batches a node with one it depends on.
+	for(int i = 0; i < count; i++) {
+		Node* n = static_cast<Node*>(jobs[i].get());
+		if(n->beginTick()) nodes[active++] = n;
+	}
+	if(active) nodes[0]->processBatch(active, nodes);
+	for(int i = 0; i < active; i++) nodes[i]->endTick();
+}
+
 bool Node::canCull() {
 	return getState() == Lav_NODESTATE_PAUSED;
 }
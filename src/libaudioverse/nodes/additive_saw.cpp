@@ -16,7 +16,8 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 
 namespace libaudioverse_implementation {
 
-AdditiveSawNode::AdditiveSawNode(std::shared_ptr<Server> server): Node(Lav_OBJTYPE_ADDITIVE_SAW_NODE, server, 0, 1), oscillator(server->getSr()) {
+AdditiveSawNode::AdditiveSawNode(std::shared_ptr<Server> server): Node(Lav_OBJTYPE_ADDITIVE_SAW_NODE, server, 0, 1), oscillator(server->getSr()),
+wavetable(server->getSr(), AdditiveWaveforms::SAW) {
 	appendOutputConnection(0, 1);
 	setShouldZeroOutputBuffers(false);
 }
@@ -26,20 +27,39 @@ std::shared_ptr<Node> createAdditiveSawNode(std::shared_ptr<Server> server) {
 }
 
 void AdditiveSawNode::process() {
-	if(werePropertiesModified(this, Lav_SAW_HARMONICS)) oscillator.setHarmonics(getProperty(Lav_SAW_HARMONICS).getIntValue());
-	if(werePropertiesModified(this, Lav_OSCILLATOR_PHASE)) oscillator.setPhase(getProperty(Lav_OSCILLATOR_PHASE).getFloatValue()+oscillator.getPhase());
+	if(werePropertiesModified(this, Lav_ADDITIVE_OSCILLATOR_USE_WAVETABLE)) {
+		bool newValue = getProperty(Lav_ADDITIVE_OSCILLATOR_USE_WAVETABLE).getIntValue() == 1;
+		//Carry the phase across so that switching doesn't click.
+		if(newValue && use_wavetable == false) {
+			wavetable.setHarmonics(getProperty(Lav_SAW_HARMONICS).getIntValue());
+			wavetable.setPhase(oscillator.getPhase());
+		}
+		else if(newValue == false && use_wavetable) oscillator.setPhase(wavetable.getPhase());
+		use_wavetable = newValue;
+	}
+	if(werePropertiesModified(this, Lav_SAW_HARMONICS)) {
+		oscillator.setHarmonics(getProperty(Lav_SAW_HARMONICS).getIntValue());
+		if(use_wavetable) wavetable.setHarmonics(getProperty(Lav_SAW_HARMONICS).getIntValue());
+	}
+	if(use_wavetable) processOscillator(wavetable);
+	else processOscillator(oscillator);
+}
+
+template<typename OscillatorT>
+void AdditiveSawNode::processOscillator(OscillatorT &osc) {
+	if(werePropertiesModified(this, Lav_OSCILLATOR_PHASE)) osc.setPhase(getProperty(Lav_OSCILLATOR_PHASE).getFloatValue()+osc.getPhase());
 	auto &freq = getProperty(Lav_OSCILLATOR_FREQUENCY);
 	auto &freqMul = getProperty(Lav_OSCILLATOR_FREQUENCY_MULTIPLIER);
 	if(freq.needsARate() || freqMul.needsARate()) {
 		for(int i = 0; i < block_size; i++) {
-			oscillator.setFrequency(freq.getFloatValue(i)*freqMul.getFloatValue(i));
-			output_buffers[0][i] = oscillator.tick();
+			osc.setFrequency(freq.getFloatValue(i)*freqMul.getFloatValue(i));
+			output_buffers[0][i] = osc.tick();
 		}
 	}
 	else {
-		oscillator.setFrequency(freq.getFloatValue()*freqMul.getFloatValue());
+		osc.setFrequency(freq.getFloatValue()*freqMul.getFloatValue());
 		for(int i = 0; i < block_size; i++) {
-			output_buffers[0][i] = oscillator.tick();
+			output_buffers[0][i] = osc.tick();
 		}
 	}
 }
@@ -47,6 +67,8 @@ void AdditiveSawNode::process() {
 void AdditiveSawNode::reset() {
 	oscillator.reset();
 	oscillator.setPhase(getProperty(Lav_OSCILLATOR_PHASE).getFloatValue());
+	wavetable.reset();
+	wavetable.setPhase(getProperty(Lav_OSCILLATOR_PHASE).getFloatValue());
 }
 
 //begin public api
@@ -14,7 +14,9 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/implementations/biquad.hpp>
 #include <libaudioverse/private/multichannel_filter_bank.hpp>
+#include <libaudioverse/private/planner.hpp>
 #include <memory>
+#include <algorithm>
 
 
 namespace libaudioverse_implementation {
@@ -45,10 +47,69 @@ void BiquadNode::reconfigure() {
 }
 
 void BiquadNode::process() {
-	if(werePropertiesModified(this, Lav_BIQUAD_FILTER_TYPE, Lav_BIQUAD_DBGAIN, Lav_BIQUAD_FREQUENCY, Lav_BIQUAD_Q)) reconfigure();
+	if(isModulated()) {
+		processModulated();
+		return;
+	}
+	if(was_modulated || werePropertiesModified(this, Lav_BIQUAD_FILTER_TYPE, Lav_BIQUAD_DBGAIN, Lav_BIQUAD_FREQUENCY, Lav_BIQUAD_Q)) reconfigure();
+	was_modulated = false;
 	bank.process(block_size, &input_buffers[0], &output_buffers[0]);
 }
 
+bool BiquadNode::isModulated() {
+	return getProperty(Lav_BIQUAD_FREQUENCY).needsARate() || getProperty(Lav_BIQUAD_Q).needsARate() || getProperty(Lav_BIQUAD_DBGAIN).needsARate();
+}
+
+void BiquadNode::processModulated() {
+	int type = getProperty(Lav_BIQUAD_FILTER_TYPE).getIntValue();
+	if(type != prev_type) bank.reset();
+	prev_type = type;
+	auto &freq = getProperty(Lav_BIQUAD_FREQUENCY);
+	auto &q = getProperty(Lav_BIQUAD_Q);
+	auto &dbgain = getProperty(Lav_BIQUAD_DBGAIN);
+	double sr = server->getSr();
+	BiquadFilter* lanes[4];
+	float* inputs[4], *outputs[4];
+	double target[5];
+	for(int start = 0; start < block_size; start += BIQUAD_MODULATION_INTERVAL) {
+		int length = std::min(BIQUAD_MODULATION_INTERVAL, block_size-start);
+		int last = start+length-1;
+		biquadDesignCached(sr, type, freq.getFloatValue(last), dbgain.getFloatValue(last), q.getFloatValue(last), target);
+		int channel = 0, used = 0;
+		for(BiquadFilter* f = bank.operator->(); f; f = f->getSlave(), channel++) {
+			lanes[used] = f;
+			inputs[used] = input_buffers[channel]+start;
+			outputs[used] = output_buffers[channel]+start;
+			used++;
+			if(used == 4 || f->getSlave() == nullptr) {
+				BiquadFilter::processLanesRamped(used, lanes, length, inputs, outputs, target);
+				used = 0;
+			}
+		}
+	}
+	was_modulated = true;
+}
+
+void BiquadNode::processBatch(int count, Node** nodes) {
+	MultichannelFilterBank<BiquadFilter>* banks[PLANNER_MAX_BATCH];
+	float** inputs[PLANNER_MAX_BATCH], **outputs[PLANNER_MAX_BATCH];
+	int used = 0;
+	for(int i = 0; i < count; i++) {
+		BiquadNode* n = static_cast<BiquadNode*>(nodes[i]);
+		if(n->isModulated()) {
+			n->processModulated();
+			continue;
+		}
+		if(n->was_modulated || werePropertiesModified(n, Lav_BIQUAD_FILTER_TYPE, Lav_BIQUAD_DBGAIN, Lav_BIQUAD_FREQUENCY, Lav_BIQUAD_Q)) n->reconfigure();
+		n->was_modulated = false;
+		banks[used] = &n->bank;
+		inputs[used] = &n->input_buffers[0];
+		outputs[used] = &n->output_buffers[0];
+		used++;
+	}
+	if(used) processBanksTogether(used, banks, block_size, inputs, outputs);
+}
+
 void BiquadNode::reset() {
 	bank.reset();
 }
@@ -26,9 +26,11 @@ ConvolverNode::ConvolverNode(std::shared_ptr<Server> server, int channels): Node
 	appendInputConnection(0, channels);
 	this->channels=channels;
 	appendOutputConnection(0, channels);
-	convolvers=new BlockConvolver*[channels]();
-	for(int i= 0; i < channels; i++) convolvers[i] = new BlockConvolver(server->getBlockSize());
+	convolvers=new AutomaticConvolver*[channels]();
+	for(int i= 0; i < channels; i++) convolvers[i] = new AutomaticConvolver(server->getBlockSize());
 	setShouldZeroOutputBuffers(false);
+	//Applied as soon as it's set rather than at the next block, so that it and setTaps replace each other in the order they're called.
+	getProperty(Lav_CONVOLVER_IMPULSE_RESPONSE).setPostChangedCallback([&] () {setImpulseResponse();});
 }
 
 std::shared_ptr<Node> createConvolverNode(std::shared_ptr<Server> server, int channels) {
@@ -41,7 +43,6 @@ ConvolverNode::~ConvolverNode() {
 }
 
 void ConvolverNode::process() {
-	if(werePropertiesModified(this, Lav_CONVOLVER_IMPULSE_RESPONSE)) setImpulseResponse();
 	for(int i= 0; i < channels; i++) convolvers[i]->convolve(input_buffers[i], output_buffers[i]);
 }
 
@@ -51,6 +52,11 @@ void ConvolverNode::setImpulseResponse() {
 	for(int i = 0; i < channels; i++) convolvers[i]->setResponse(len, ir);
 }
 
+void ConvolverNode::setTaps(int count, int* delays, float* gains) {
+	if(count < 0) ERROR(Lav_ERROR_RANGE, "Tap count must not be negative.");
+	for(int i = 0; i < channels; i++) convolvers[i]->setTaps(count, delays, gains);
+}
+
 //begin public api
 
 Lav_PUBLIC_FUNCTION LavError Lav_createConvolverNode(LavHandle serverHandle, int channels, LavHandle* destination) {
@@ -62,4 +68,12 @@ Lav_PUBLIC_FUNCTION LavError Lav_createConvolverNode(LavHandle serverHandle, int
 	PUB_END
 }
 
+Lav_PUBLIC_FUNCTION LavError Lav_convolverNodeSetTaps(LavHandle nodeHandle, int count, int* delays, float* gains) {
+	PUB_BEGIN
+	auto n = incomingObject<ConvolverNode>(nodeHandle);
+	LOCK(*n);
+	n->setTaps(count, delays, gains);
+	PUB_END
+}
+
 }
\ No newline at end of file
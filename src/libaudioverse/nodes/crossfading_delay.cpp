@@ -13,7 +13,9 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/implementations/delayline.hpp>
+#include <libaudioverse/private/kernels.hpp>
 #include <memory>
+#include <algorithm>
 
 namespace libaudioverse_implementation {
 
@@ -60,11 +62,15 @@ void CrossfadingDelayNode::process() {
 		}
 	}
 	else {
+		float advanced[DELAY_LINE_BLOCK_LENGTH];
 		for(unsigned int output = 0; output < num_output_buffers; output++) {
 			auto &line = *lines[output];
-			for(unsigned int i = 0; i < block_size; i++) {
-				output_buffers[output][i] = line.computeSample();
-				line.advance(input_buffers[output][i]+output_buffers[output][i]*feedback);
+			int i = 0;
+			while(i < block_size) {
+				int count = line.readBlock(std::min(block_size-i, DELAY_LINE_BLOCK_LENGTH), output_buffers[output]+i);
+				multiplicationAdditionKernel(count, feedback, output_buffers[output]+i, input_buffers[output]+i, advanced);
+				line.writeBlock(count, advanced);
+				i += count;
 			}
 		}
 	}
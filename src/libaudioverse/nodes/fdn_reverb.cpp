@@ -13,16 +13,15 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/dspmath.hpp>
-#include <libaudioverse/implementations/delayline.hpp>
-#include <libaudioverse/implementations/one_pole_filter.hpp>
-#include <libaudioverse/implementations/interpolated_random_generator.hpp>
+#include <libaudioverse/implementations/fdn_reverb_core.hpp>
 #include <algorithm>
 #include <random> //we need the random sequence.
 
 namespace libaudioverse_implementation {
 
 /**This is a reverb based off a householder reflectiona bout the vector [1, 1, 1, 1, 1...].
-We implement the reflection directly in order to avoid needing a full FDN.
+We implement the reflection directly in order to avoid needing a full FDN; see FdnReverbCore.
+See https://ccrma.stanford.edu/~jos/pasp/Householder_Feedback_Matrix.html for the formulas.
 */
 
 //constant data
@@ -47,18 +46,13 @@ float modulation_duration = 0.01f;
 
 FdnReverbNode::FdnReverbNode(std::shared_ptr<Server> s): Node(Lav_OBJTYPE_FDN_REVERB_NODE, s, 4, 4) {
 	std::fill(feedback_gains, feedback_gains+8, 0.0f);
-	delay_lines = new InterpolatedDelayLine*[8];
-	delay_line_modulators = new InterpolatedRandomGenerator*[8];
-	lowpass_filters = new OnePoleFilter*[8]();
 	double sr = server->getSr();
 	int seeds[8];
 	std::seed_seq seq{1, 2, 3, 4, 5, 6, 7, 8};
 	seq.generate(seeds, seeds+8);
-	for(int  i = 0; i < 8; i++) {
-		delay_lines[i] = new InterpolatedDelayLine(1.0, sr);
-		delay_line_modulators[i] = new InterpolatedRandomGenerator(sr, seeds[i]);
-		lowpass_filters[i] = new OnePoleFilter(sr);
-	}
+	//The longest delay the properties allow, plus the deepest modulation.
+	float maxDelay = (min_delay_multiplier+delay_multiplier_variation)*delays[7]+modulation_duration;
+	core = new FdnReverbCore(sr, maxDelay, seeds);
 	appendInputConnection(0, 4);
 	appendOutputConnection(0, 4);
 	getProperty(Lav_FDN_REVERB_CUTOFF_FREQUENCY).setFloatRange(0.0f, sr/2.0);
@@ -70,19 +64,7 @@ std::shared_ptr<Node> createFdnReverbNode(std::shared_ptr<Server> server) {
 }
 
 FdnReverbNode::~FdnReverbNode() {
-	for(int i = 0; i < 8; i++) {
-		delete delay_lines[i];
-		delete lowpass_filters[i];
-	}
-	delete[] delay_lines;
-	delete[] lowpass_filters;
-}
-
-void FdnReverbNode::modulateLines() {
-	if(needs_modulation == false) return;
-	for(int i = 0; i < 8; i++) {
-		delay_lines[i]->setDelay(current_delays[i]+modulation_depth*delay_line_modulators[i]->tick());
-	}
+	delete core;
 }
 
 void FdnReverbNode::process() {
@@ -90,40 +72,7 @@ void FdnReverbNode::process() {
 	Lav_FDN_REVERB_DENSITY,
 	Lav_FDN_REVERB_DELAY_MODULATION_FREQUENCY, Lav_FDN_REVERB_DELAY_MODULATION_DEPTH
 	)) reconfigureModel();
-	float lineValues[8];
-	float feedbacks[8];
-	for(int sample = 0; sample < block_size; sample++) {
-		/*Since the vector is [1, 1, 1, 1, 1...] we have already multiplied by it.
-		See https://ccrma.stanford.edu/~jos/pasp/Householder_Feedback_Matrix.html for the formulas we're using heere.
-		In the form we use, a householder matrix has a diagonal of (1-2/n) and a nondiagonal of -2/n.
-		In this algorithm, n is 8.
-		*/
-		//First, read from the lines.
-		for(int i = 0; i < 8; i++) lineValues[i] = delay_lines[i]->computeSample();
-		//The line values are output at this point.
-		for(int i = 0; i < 8; i++) output_buffers[i%4][sample] = lineValues[i];
-		//Do the feedback path.
-		//Sum them to get the value of the row as though it were positive and 2/n all the way across.
-		float lineSum = 0.0f;
-		for(int i = 0; i < 8; i++) lineSum += lineValues[i];
-		lineSum *= 0.25;
-		/**The first row of a householder matrix is:
-		(1-e), -e, -e, -e, -e, -e, -e, -e
-		Where e=2/n.
-		Subsequent rows simply move the (1-e) term.
-		We have the result of the -e vector, essentially, and need only account for the missing 1. Consequently, the following.
-		*/
-		for(int i = 0; i < 8; i++) {
-			feedbacks[i] = lineValues[i]-lineSum;
-			feedbacks[i] *= feedback_gains[i];
-			feedbacks[i] = lowpass_filters[i]->tick(feedbacks[i]);
-		}
-		//Bring the inputs in to the first four lines.
-		for(int i = 0; i < 8; i++) feedbacks[i] += input_buffers[i%4][sample];
-		//Write outputs.
-		for(int i = 0; i < 8; i++) delay_lines[i]->advance(feedbacks[i]);
-		modulateLines();
-	}
+	core->process(block_size, &input_buffers[0], &output_buffers[0]);
 }
 
 void FdnReverbNode::reconfigureModel() {
@@ -137,20 +86,13 @@ void FdnReverbNode::reconfigureModel() {
 		float dbPerDelay = current_delays[i]*dbPerSec;
 		float gain = dbToScalar(dbPerDelay, 1.0);
 		feedback_gains[i] = gain;
-		delay_lines[i]->setDelay(current_delays[i]);
-		lowpass_filters[i]->setPoleFromFrequency(cutoff);
 	}
-	//Do we need to modulate.
+	core->setDelays(current_delays);
+	core->setFeedbackGains(feedback_gains);
+	core->setCutoff(cutoff);
 	float modDepth = getProperty(Lav_FDN_REVERB_DELAY_MODULATION_DEPTH).getFloatValue();
 	float modFreq = getProperty(Lav_FDN_REVERB_DELAY_MODULATION_FREQUENCY).getFloatValue();
-	if(modDepth == 0.0 || modFreq == 0.0) {
-		needs_modulation = false;
-	}
-	else {
-		needs_modulation = true;
-		modulation_depth = modDepth*modulation_duration;
-		for(int i = 0; i < 8; i++)  delay_line_modulators[i]->setFrequency(modFreq);
-	}
+	core->setModulation(modDepth*modulation_duration, modFreq);
 }
 
 //begin public api.
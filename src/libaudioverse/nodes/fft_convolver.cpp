@@ -19,16 +19,28 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/kernels.hpp>
 #include <libaudioverse/implementations/convolvers.hpp>
 #include <string>
+#include <vector>
 
 namespace libaudioverse_implementation {
 
+FftConvolverNodeResponse::~FftConvolverNodeResponse() {
+}
+
 FftConvolverNode::FftConvolverNode(std::shared_ptr<Server> server, int channels): Node(Lav_OBJTYPE_FFT_CONVOLVER_NODE, server, channels, channels) {
 	if(channels < 1) ERROR(Lav_ERROR_RANGE, "Channels must be greater than 0.");
 	appendInputConnection(0, channels);
 	this->channels=channels;
 	appendOutputConnection(0, channels);
-	convolvers=new FftConvolver*[channels]();
-	for(int i= 0; i < channels; i++) convolvers[i] = new FftConvolver(server->getBlockSize());
+	partitioned_convolvers = new PartitionedConvolver*[channels]();
+	for(int i= 0; i < channels; i++) partitioned_convolvers[i] = new PartitionedConvolver(block_size);
+	nonuniform_convolvers = new NonUniformConvolver*[channels]();
+	responses.resize(channels, std::vector<float>(1, 1.0f));
+	getProperty(Lav_FFT_CONVOLVER_MODE).setPostChangedCallback([&] () {
+		for(int i = 0; i < this->channels; i++) applyResponse(i);
+	});
+	getProperty(Lav_FFT_CONVOLVER_SHARED_INPUT).setPostChangedCallback([&] () {
+		for(int i = 0; i < this->channels; i++) applyResponse(i);
+	});
 }
 
 std::shared_ptr<Node> createFftConvolverNode(std::shared_ptr<Server> server, int channels) {
@@ -36,25 +48,113 @@ std::shared_ptr<Node> createFftConvolverNode(std::shared_ptr<Server> server, int
 }
 
 FftConvolverNode::~FftConvolverNode() {
-	for(int i = 0; i < channels; i++) delete convolvers[i];
-	delete[] convolvers;
+	for(int i = 0; i < channels; i++) {
+		if(partitioned_convolvers[i]) delete partitioned_convolvers[i];
+		if(nonuniform_convolvers[i]) delete nonuniform_convolvers[i];
+	}
+	delete[] partitioned_convolvers;
+	delete[] nonuniform_convolvers;
+	if(shared_convolver) delete shared_convolver;
 }
 
 void FftConvolverNode::process() {
+	if(shared_convolver) {
+		shared_convolver->convolve(input_buffers[0], &output_buffers[0]);
+		return;
+	}
+	bool sharedInput = getProperty(Lav_FFT_CONVOLVER_SHARED_INPUT).getIntValue() == 1;
 	for(int i= 0; i < channels; i++) {
-		convolvers[i]->convolve(input_buffers[i], output_buffers[i]);
+		float* input = sharedInput ? input_buffers[0] : input_buffers[i];
+		if(nonuniform_convolvers[i]) nonuniform_convolvers[i]->convolve(input, output_buffers[i]);
+		else partitioned_convolvers[i]->convolve(input, output_buffers[i]);
 	}
 }
 
 void FftConvolverNode::setResponse(int channel, int length, float* response) {
 	if(channel >= channels || channel < 0) ERROR(Lav_ERROR_RANGE, "Channel out of range.");
 	if(length < 1) ERROR(Lav_ERROR_RANGE, "Response must be at least one sample.");
-	convolvers[channel]->setResponse(length, response);
-	convolvers[channel]->reset();
+	int mode;
+	{
+		LOCK(*this);
+		mode = getProperty(Lav_FFT_CONVOLVER_MODE).getIntValue();
+	}
+	//The ffts of a long response take a while; don't hold up the audio thread for them.
+	//The caller's thread is already off the audio thread, so there's no worker: one would only add a hop and lose the error codes.
+	//Nor is the swap lock-free, since committing checks the mode and crossfade properties, which the API changes under the lock.
+	//It's a few pointer swaps, and what they replace goes back into prepared to be freed after unlocking.
+	//The exception is a response that changes how many partitions the convolver needs: its ring of input spectra is reallocated under the lock, which is O(ring), copying all of it.
+	auto prepared = prepareResponse(mode, length, response);
+	LOCK(*this);
+	commitResponse(channel, prepared);
+}
+
+FftConvolverNodeResponse FftConvolverNode::prepareResponse(int mode, int length, float* response) {
+	FftConvolverNodeResponse prepared;
+	prepared.mode = mode;
+	//So that committing doesn't allocate.
+	prepared.displaced.reserve(2);
+	prepared.samples.assign(response, response+length);
+	if(mode == Lav_FFT_CONVOLVER_MODE_NONUNIFORM) {
+		prepared.nonuniform.reset(new NonUniformConvolver(block_size));
+		prepared.nonuniform->setResponse(length, response);
+	}
+	else prepared.partitioned = getPartitionedResponse(block_size, length, response);
+	return prepared;
+}
+
+void FftConvolverNode::commitResponse(int channel, FftConvolverNodeResponse &prepared) {
+	responses[channel].swap(prepared.samples);
+	if(prepared.mode != getProperty(Lav_FFT_CONVOLVER_MODE).getIntValue()) {
+		//The mode changed while this was being prepared.
+		applyResponse(channel);
+		return;
+	}
+	if(prepared.mode == Lav_FFT_CONVOLVER_MODE_NONUNIFORM) {
+		//A new convolver has no history, so there's nothing to fade from.
+		NonUniformConvolver* old = nonuniform_convolvers[channel];
+		nonuniform_convolvers[channel] = prepared.nonuniform.release();
+		prepared.nonuniform.reset(old);
+		return;
+	}
+	bool crossfade = getProperty(Lav_FFT_CONVOLVER_CROSSFADE).getIntValue() == 1;
+	if(shared_convolver) shared_convolver->setResponse(channel, prepared.partitioned, crossfade, &prepared.displaced);
+	else partitioned_convolvers[channel]->setResponse(0, prepared.partitioned, crossfade, &prepared.displaced);
+}
+
+void FftConvolverNode::applyResponse(int channel) {
+	int length = (int)responses[channel].size();
+	float* response = &responses[channel][0];
+	bool nonuniform = getProperty(Lav_FFT_CONVOLVER_MODE).getIntValue() == Lav_FFT_CONVOLVER_MODE_NONUNIFORM;
+	bool shared = nonuniform == false && getProperty(Lav_FFT_CONVOLVER_SHARED_INPUT).getIntValue() == 1;
+	//Don't keep convolvers around for a configuration we no longer use.
+	if(nonuniform) {
+		if(nonuniform_convolvers[channel] == nullptr) nonuniform_convolvers[channel] = new NonUniformConvolver(block_size);
+		nonuniform_convolvers[channel]->setResponse(length, response);
+	}
+	else if(nonuniform_convolvers[channel]) {
+		delete nonuniform_convolvers[channel];
+		nonuniform_convolvers[channel] = nullptr;
+	}
+	if(shared) {
+		//The input is transformed only once for every channel.
+		if(shared_convolver == nullptr) shared_convolver = new PartitionedConvolver(block_size, channels);
+		shared_convolver->setResponse(channel, length, response);
+	}
+	else if(shared_convolver) {
+		delete shared_convolver;
+		shared_convolver = nullptr;
+	}
+	if(nonuniform == false && shared == false) {
+		if(partitioned_convolvers[channel] == nullptr) partitioned_convolvers[channel] = new PartitionedConvolver(block_size);
+		partitioned_convolvers[channel]->setResponse(length, response);
+	}
+	else if(partitioned_convolvers[channel]) {
+		delete partitioned_convolvers[channel];
+		partitioned_convolvers[channel] = nullptr;
+	}
 }
 
-void FftConvolverNode::setResponseFromFile(std::string path, int fileChannel, int convolverChannel) {
-	if(convolverChannel < 0 || convolverChannel >= channels) ERROR(Lav_ERROR_RANGE, "Channel out of range.");
+std::vector<float> FftConvolverNode::readResponseFile(std::string path, int fileChannel) {
 	if(fileChannel < 0) ERROR(Lav_ERROR_RANGE, "File channel must be positive.");
 	FileReader reader{};
 	reader.open(path.c_str());
@@ -69,10 +169,10 @@ void FftConvolverNode::setResponseFromFile(std::string path, int fileChannel, in
 	float* resampledTmp;
 	int resampledTmpLength;
 	staticResamplerKernel(reader.getSr(), server->getSr(), 1, reader.getFrameCount(), tmp, &resampledTmpLength, &resampledTmp);
-	//Finally, set the specified convolver.
-	setResponse(convolverChannel, resampledTmpLength, resampledTmp);
+	std::vector<float> response(resampledTmp, resampledTmp+resampledTmpLength);
 	freeArray(tmp);
 	delete[] resampledTmp;
+	return response;
 }
 
 //begin public api
@@ -86,10 +186,10 @@ Lav_PUBLIC_FUNCTION LavError Lav_createFftConvolverNode(LavHandle serverHandle,
 	PUB_END
 }
 
+//These two don't lock: the node takes its lock only to read the mode and to swap the prepared response in.
 Lav_PUBLIC_FUNCTION LavError Lav_fftConvolverNodeSetResponse(LavHandle nodeHandle, int channel, int length, float* response) {
 	PUB_BEGIN
 	auto n = incomingObject<FftConvolverNode>(nodeHandle);
-	LOCK(*n);
 	n->setResponse(channel, length, response);
 	PUB_END
 }
@@ -97,8 +197,9 @@ Lav_PUBLIC_FUNCTION LavError Lav_fftConvolverNodeSetResponse(LavHandle nodeHandl
 Lav_PUBLIC_FUNCTION LavError Lav_fftConvolverNodeSetResponseFromFile(LavHandle nodeHandle, const char* path, int fileChannel, int convolverChannel) {
 	PUB_BEGIN
 	auto n = incomingObject<FftConvolverNode>(nodeHandle);
-	LOCK(*n);
-	n->setResponseFromFile(path, fileChannel, convolverChannel);
+	if(convolverChannel < 0 || convolverChannel >= n->channels) ERROR(Lav_ERROR_RANGE, "Channel out of range.");
+	auto response = n->readResponseFile(path, fileChannel);
+	n->setResponse(convolverChannel, (int)response.size(), &response[0]);
 	PUB_END
 }
 
@@ -13,6 +13,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/implementations/delayline.hpp>
+#include <libaudioverse/private/kernels.hpp>
 #include <libaudioverse/implementations/biquad.hpp>
 #include <memory>
 #include <algorithm>
@@ -79,21 +80,25 @@ void FilteredDelayNode::process() {
 	//optimize the common case of not having feedback.
 	//the only difference between these blocks is in the advance line.
 	if(feedback == 0.0f) {
-		for(unsigned int output = 0; output < num_output_buffers; output++) {
-			auto &line = *lines[output];
-			auto &filter=*biquads[output];
-			line.processBuffer(block_size, input_buffers[output], output_buffers[output]);
-			for(int i=0; i < block_size; i++) output_buffers[output][i] = filter.tick(output_buffers[output][i]);
+		for(unsigned int output = 0; output < num_output_buffers; output++) lines[output]->processBuffer(block_size, input_buffers[output], output_buffers[output]);
+		//Without feedback the filters don't depend on the lines, so we can filter 4 channels at once.
+		for(int channel = 0; channel < channels; channel += 4) {
+			BiquadFilter::processLanes(std::min(4, channels-channel), biquads+channel, block_size, &output_buffers[channel], &output_buffers[channel]);
 		}
 	}
 	else {
+		float advanced[DELAY_LINE_BLOCK_LENGTH];
 		for(unsigned int output = 0; output < num_output_buffers; output++) {
 			auto &line = *lines[output];
 			auto &filter = *biquads[output];
-			for(unsigned int i = 0; i < block_size; i++) {
-				output_buffers[output][i] = line.computeSample();
-				output_buffers[output][i] = filter.tick(output_buffers[output][i]);
-				line.advance(input_buffers[output][i]+output_buffers[output][i]*feedback);
+			int i = 0;
+			while(i < block_size) {
+				float* out = output_buffers[output]+i;
+				int count = line.readBlock(std::min(block_size-i, DELAY_LINE_BLOCK_LENGTH), out);
+				for(int j = 0; j < count; j++) out[j] = filter.tick(out[j]);
+				multiplicationAdditionKernel(count, feedback, out, input_buffers[output]+i, advanced);
+				line.writeBlock(count, advanced);
+				i += count;
 			}
 		}
 	}
@@ -46,8 +46,8 @@ void HrtfNode::reset() {
 Lav_PUBLIC_FUNCTION LavError Lav_createHrtfNode(LavHandle serverHandle, const char* hrtfPath, LavHandle* destination) {
 	PUB_BEGIN
 	auto server = incomingObject<Server>(serverHandle);
+	auto hrtf = createHrtfForServer(hrtfPath, server);
 	LOCK(*server);
-	auto hrtf = createHrtfFromString(hrtfPath, server->getSr());
 	auto retval = createHrtfNode(server, hrtf);
 	*destination = outgoingObject<Node>(retval);
 	PUB_END
@@ -40,10 +40,7 @@ IirNode::~IirNode() {
 }
 
 void IirNode::process() {
-	for(unsigned int i = 0; i < channels; i++) {
-		auto &f = *filters[i];
-		for(int j = 0; j < block_size; j++) output_buffers[i][j] = f.tick(input_buffers[i][j]);
-	}
+	for(unsigned int i = 0; i < channels; i++) filters[i]->process(block_size, input_buffers[i], output_buffers[i]);
 }
 
 void IirNode::setCoefficients(int numeratorLength, double* numerator, int denominatorLength, double* denominator, int shouldClearHistory) {
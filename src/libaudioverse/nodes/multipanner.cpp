@@ -73,8 +73,8 @@ void MultipannerNode::reset() {
 Lav_PUBLIC_FUNCTION LavError Lav_createMultipannerNode(LavHandle serverHandle, char* hrtfPath, LavHandle* destination) {
 	PUB_BEGIN
 	auto server = incomingObject<Server>(serverHandle);
+	auto hrtf = createHrtfForServer(hrtfPath, server);
 	LOCK(*server);
-	auto hrtf = createHrtfFromString(hrtfPath, server->getSr());
 	*destination = outgoingObject<Node>(createMultipannerNode(server, hrtf));
 	PUB_END
 }
@@ -12,35 +12,35 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/properties.hpp>
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/memory.hpp>
-#include <libaudioverse/implementations/iir.hpp>
-#include <random>
+#include <libaudioverse/private/kernels.hpp>
+#include <libaudioverse/implementations/noise_generator.hpp>
+#include <math.h>
 
 namespace libaudioverse_implementation {
 
-//we give the random number generator a fixed seed for debugging purposes.
+//we give the generator a fixed seed for debugging purposes.
 //Normal distribution with standard deviation 0.25, more than 99% of values are less than 1.
 NoiseNode::NoiseNode(std::shared_ptr<Server> server): Node(Lav_OBJTYPE_NOISE_NODE, server, 0, 1),
-random_number_generator(1234), normal_distribution(0.0f, 0.25f),
-pinkifier(server->getSr()),
-brownifier(server->getSr()) {
-	/**We have to configure the pinkifier.
-This was originally taken from Spectral Audio processing by JOS.*/
-	//zeros
-	double pinkNumer[] = {0.049922035, -0.095993537, 0.050612699, -0.004408786};
-	//and the poles.
-	double pinkDenom[] = {1, -2.494956002,   2.017265875,  -0.522189400};
-	pinkifier.configure(sizeof(pinkNumer)/sizeof(double), pinkNumer, sizeof(pinkDenom)/sizeof(double), pinkDenom);
-	//this is a butterworth filter designed with the following numpy code:
-	//b, a = butter(1, 0.002)
-	//this is not 100% accurate, but it is doubtful that the error is audible.
-	double brownNumer[] = {0.00313176, 0.00313176};
-	double brownDenom[] = {1.0, -0.99373647};
-	brownifier.configure(sizeof(brownNumer)/sizeof(double), brownNumer, sizeof(brownDenom)/sizeof(double), brownDenom);
+generator(1234) {
+	/**The pinkifier was originally taken from Spectral Audio processing by JOS:
+	b = {0.049922035, -0.095993537, 0.050612699, -0.004408786}
+	a = {1, -2.494956002,   2.017265875,  -0.522189400}
+	The brownifier is a butterworth filter designed with the following numpy code:
+	b, a = butter(1, 0.002)
+	which gives b = {0.00313176, 0.00313176}, a = {1.0, -0.99373647}.
+	This is not 100% accurate, but it is doubtful that the error is audible.
+	Both have real poles, so we run them as parallel one-pole sections.
+	The poles, residues and direct terms below are scipy.signal.residuez of the above.*/
 	//the pinkifier and brownifier are too quiet, so we bump them up some.
 	//these numbers were obtained by listening to the output and adjusting.
-	//if users need to have the noise on the range-1.0 to 1.0, they can use should_normalize=Truewhich works for all but absurdly small block sizes.
-	pinkifier.setGain(4.0);
-	brownifier.setGain(12.0);
+	//if users need to have the noise on the range-1.0 to 1.0, they can use should_normalize=True which works for all but absurdly small block sizes.
+	const double pinkGain = 4.0, brownGain = 12.0;
+	double pinkPoles[] = {0.9951689689158142, 0.9438417737128169, 0.5559452593713645};
+	double pinkResidues[] = {0.004150603199613301*pinkGain, 0.009478210266844703*pinkGain, 0.027850334718911317*pinkGain};
+	pinkifier.configure(3, pinkPoles, pinkResidues, 0.00844288681463086*pinkGain);
+	double brownPoles[] = {0.99373647};
+	double brownResidues[] = {0.006283259511736748*brownGain};
+	brownifier.configure(1, brownPoles, brownResidues, -0.0031514995117367483*brownGain);
 	appendOutputConnection(0, 1);
 	setShouldZeroOutputBuffers(false);
 }
@@ -50,37 +50,28 @@ std::shared_ptr<Node> createNoiseNode(std::shared_ptr<Server> server) {
 }
 
 void NoiseNode::white() {
+	generator.white(block_size, output_buffers[0]);
+}
+
+void NoiseNode::normalize(float &max) {
+	//pass over the output buffer and find the max sample.
 	for(int i = 0; i < block_size; i++) {
-		//if this proves too costly, revisit and examine the box-muller method.
-		float noiseSample = 0.0;
-		do {
-			noiseSample = normal_distribution(random_number_generator);
-		} while(noiseSample < -1.0f || noiseSample > 1.0f);
-		output_buffers[0][i] = noiseSample;
+		if(fabs(output_buffers[0][i]) > max) max = fabs(output_buffers[0][i]);
 	}
+	if(getProperty(Lav_NOISE_SHOULD_NORMALIZE).getIntValue() == 0 || max == 0.0f) return;
+	scalarMultiplicationKernel(block_size, 1.0f/max, output_buffers[0], output_buffers[0]);
 }
 
 void NoiseNode::pink() {
 	white();
-	for(int i = 0; i < block_size; i++) output_buffers[0][i] =pinkifier.tick(output_buffers[0][i]);
-	//pass over the output buffer and find the max sample.
-	for(int i = 0; i < block_size; i++) {
-		if(fabs(output_buffers[0][i]) > pink_max) pink_max= fabs(output_buffers[0][i]);
-	}
-	if(getProperty(Lav_NOISE_SHOULD_NORMALIZE).getIntValue() == 0 || pink_max == 0.0f) return;
-	for(int i = 0; i < block_size; i++) output_buffers[0][i]/=pink_max;
+	pinkifier.process(block_size, output_buffers[0], output_buffers[0]);
+	normalize(pink_max);
 }
 
 void NoiseNode::brown() {
 	white();
-	for(int i= 0; i < block_size; i++) output_buffers[0][i]=brownifier.tick(output_buffers[0][i]);
-	//do something to make brown noise here...
-	//pass over the output buffer and find the max sample.
-	for(int i = 0; i < block_size; i++) {
-		if(fabs(output_buffers[0][i]) > brown_max) brown_max= fabs(output_buffers[0][i]);
-	}
-	if(getProperty(Lav_NOISE_SHOULD_NORMALIZE).getIntValue() == 0 || brown_max == 0.0f) return;
-	for(int i = 0; i < block_size; i++) output_buffers[0][i]/=brown_max;
+	brownifier.process(block_size, output_buffers[0], output_buffers[0]);
+	normalize(brown_max);
 }
 
 void NoiseNode::process() {
@@ -14,6 +14,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/macros.hpp>
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/multichannel_filter_bank.hpp>
+#include <libaudioverse/private/planner.hpp>
 #include <memory>
 
 namespace libaudioverse_implementation {
@@ -49,6 +50,26 @@ void OnePoleFilterNode::process() {
 	else bank.process(block_size, &input_buffers[0], &output_buffers[0]);
 }
 
+void OnePoleFilterNode::processBatch(int count, Node** nodes) {
+	//a-rate frequencies reconfigure every sample, so those nodes go through process.
+	MultichannelFilterBank<OnePoleFilter>* banks[PLANNER_MAX_BATCH];
+	float** inputs[PLANNER_MAX_BATCH], **outputs[PLANNER_MAX_BATCH];
+	int used = 0;
+	for(int i = 0; i < count; i++) {
+		OnePoleFilterNode* n = static_cast<OnePoleFilterNode*>(nodes[i]);
+		if(n->getProperty(Lav_ONE_POLE_FILTER_FREQUENCY).needsARate()) {
+			n->process();
+			continue;
+		}
+		if(werePropertiesModified(n, Lav_ONE_POLE_FILTER_IS_HIGHPASS, Lav_ONE_POLE_FILTER_FREQUENCY)) n->reconfigureFilters();
+		banks[used] = &n->bank;
+		inputs[used] = &n->input_buffers[0];
+		outputs[used] = &n->output_buffers[0];
+		used++;
+	}
+	if(used) processBanksTogether(used, banks, block_size, inputs, outputs);
+}
+
 //begin public api.
 
 Lav_PUBLIC_FUNCTION LavError Lav_createOnePoleFilterNode(LavHandle serverHandle, int channels, LavHandle* destination) {
@@ -14,6 +14,7 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/memory.hpp>
 #include <libaudioverse/private/constants.hpp>
 #include <libaudioverse/implementations/sin_osc.hpp>
+#include <libaudioverse/private/planner.hpp>
 
 namespace libaudioverse_implementation {
 
@@ -44,6 +45,32 @@ void SineNode::process() {
 	}
 }
 
+void SineNode::processBatch(int count, Node** nodes) {
+	//Nodes with a-rate frequencies change the rotation every sample, so only the rest run together.
+	SinOsc* oscillators[4];
+	float* outputs[4];
+	int used = 0;
+	for(int i = 0; i < count; i++) {
+		SineNode* n = static_cast<SineNode*>(nodes[i]);
+		auto &freq = n->getProperty(Lav_OSCILLATOR_FREQUENCY);
+		auto &freqMul = n->getProperty(Lav_OSCILLATOR_FREQUENCY_MULTIPLIER);
+		if(freq.needsARate() | freqMul.needsARate()) {
+			n->process();
+			continue;
+		}
+		if(werePropertiesModified(n, Lav_OSCILLATOR_PHASE)) n->oscillator.setPhase(n->oscillator.getPhase()+n->getProperty(Lav_OSCILLATOR_PHASE).getFloatValue());
+		n->oscillator.setFrequency(freq.getFloatValue()*freqMul.getFloatValue());
+		oscillators[used] = &n->oscillator;
+		outputs[used] = n->output_buffers[0];
+		used++;
+		if(used == 4) {
+			SinOsc::tickLanes(used, oscillators, block_size, outputs);
+			used = 0;
+		}
+	}
+	if(used) SinOsc::tickLanes(used, oscillators, block_size, outputs);
+}
+
 void SineNode::reset() {
 	oscillator.reset();
 	oscillator.setPhase(getProperty(Lav_OSCILLATOR_PHASE).getFloatValue());
@@ -52,12 +52,27 @@ void jobExecutor(std::shared_ptr<Job> &j) {
 	j->job_recorded = false;
 }
 
+void batchExecutor(int count, std::shared_ptr<Job>* jobs) {
+	jobs[0]->executeBatch(count, jobs);
+	for(int i = 0; i < count; i++) jobs[i]->job_recorded = false;
+}
+
+void Job::executeBatch(int count, std::shared_ptr<Job>* jobs) {
+	for(int i = 0; i < count; i++) jobs[i]->execute();
+}
+
+void Planner::runBatch(std::vector<std::shared_ptr<Job>> &bin, std::vector<int> &starts, int which) {
+	int start = starts[which];
+	int end = which+1 < (int)starts.size() ? starts[which+1] : (int)bin.size();
+	if(end-start == 1) jobExecutor(bin[start]);
+	else batchExecutor(end-start, &bin[start]);
+}
+
 void Planner::runJobsSync() {
 	becomeAudioThread();
 	for(auto &bin: plan) {
-		for(auto &j: bin.second) {
-			jobExecutor(j);
-		}
+		auto &starts = batch_starts[bin.first];
+		for(int i = 0; i < (int)starts.size(); i++) runBatch(bin.second, starts, i);
 	}
 	//We are potentially sharing this thread with someone else. It is important that we don't accidentally give them high priority too.
 	unbecomeAudioThread();
@@ -68,7 +83,9 @@ void Planner::runJobsAsync() {
 	//Putting it here greatly simplifies thread pool startup logic.
 	thread_pool.submitJobToAllThreads(becomeAudioThread);
 	for(auto &bin: plan) {
-		thread_pool.map(jobExecutor, bin.second.begin(), bin.second.end());
+		auto &jobs = bin.second;
+		auto &starts = batch_starts[bin.first];
+		thread_pool.map([&] (int which) {runBatch(jobs, starts, which);}, batch_indices.begin(), batch_indices.begin()+starts.size());
 		thread_pool.submitBarrier();
 	}
 	//At this point, submit a meaningless job that does nothing.
@@ -102,6 +119,7 @@ void Planner::replan(std::shared_ptr<Job> start) {
 	logDebug("Replanning.");
 	//Fill the vector with the jobs.
 	binner(start, 0, plan);
+	findBatches();
 	is_valid = true;
 	//Put in weak_plan, the cache.
 	//We do two loops because we really don't want to keep deleting and recreating the vectors.
@@ -114,6 +132,40 @@ void Planner::replan(std::shared_ptr<Job> start) {
 	}
 }
 
+//Sets found if job is one of [first, last).
+inline void batchMemberFinder(std::shared_ptr<Job> job, std::shared_ptr<Job>* first, std::shared_ptr<Job>* last, bool &found) {
+	if(std::find(first, last, job) != last) found = true;
+}
+
+void Planner::findBatches() {
+	batch_starts.clear();
+	int largest = 0;
+	for(auto &bin: plan) {
+		auto &jobs = bin.second;
+		//Jobs in a bin can depend on each other, and binner leaves them in an order that runs dependencies first.
+		//So we keep that order, and only batch runs of adjacent jobs of the same type.
+		//A job that depends on an earlier member of the run starts a new batch, since the batch gathers all inputs before processing any of them.
+		//Any path between two members of a run has to pass through the jobs between them, which are also members, so checking direct dependencies is enough.
+		auto &starts = batch_starts[bin.first];
+		for(int i = 0; i < (int)jobs.size(); i++) {
+			bool continues = i > 0 && i-starts.back() < PLANNER_MAX_BATCH
+			&& jobs[i]->canBatch() && jobs[i-1]->canBatch() && jobs[i]->getType() == jobs[i-1]->getType();
+			if(continues) {
+				bool dependsOnBatch = false;
+				visitDependencies(jobs[i], batchMemberFinder, &jobs[starts.back()], &jobs[i], dependsOnBatch);
+				continues = dependsOnBatch == false;
+			}
+			if(continues == false) starts.push_back(i);
+		}
+		largest = std::max(largest, (int)starts.size());
+	}
+	//thread_pool.map wants something to iterate over.
+	if((int)batch_indices.size() < largest) {
+		batch_indices.resize(largest);
+		for(int i = 0; i < largest; i++) batch_indices[i] = i;
+	}
+}
+
 void Planner::clearStrongPlan() {
 	for(auto &bin: plan) bin.second.clear();
 }
@@ -485,6 +485,10 @@ void Property::setBufferValue(std::shared_ptr<Buffer> b, bool avoidCallbacks) {
 	if(avoidCallbacks == false) firePostChangedCallback();
 }
 
+const double* Property::getValueBuffer() {
+	return value_buffer;
+}
+
 bool Property::needsARate() {
 	//This is not reliable until the property is ticked, which shouldn't be a problem.
 	return allows_arate && should_use_value_buffer;
@@ -17,9 +17,11 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <libaudioverse/private/planner.hpp>
 #include <libaudioverse/private/logging.hpp>
 #include <libaudioverse/private/helper_templates.hpp>
+#include <libaudioverse/private/hrtf.hpp>
 #include <powercores/utilities.hpp>
 #include <audio_io/audio_io.hpp>
 #include <stdlib.h>
+#include <math.h>
 #include <functional>
 #include <algorithm>
 #include <iterator>
@@ -33,6 +35,7 @@ Server::Server(unsigned int sr, unsigned int blockSize, unsigned int mixahead):
 	if(blockSize%4 || blockSize== 0) ERROR(Lav_ERROR_RANGE, "Block size must be a nonzero multiple of 4."); //only afe to have this be a multiple of four.
 	this->sr = (float)sr;
 	this->block_size = blockSize;
+	block_kernels = selectBlockKernels(blockSize);
 	this->mixahead = mixahead;
 	//fire up the background thread.
 	backgroundTaskThread = powercores::safeStartThread(&Server::backgroundTaskThreadFunction, this);
@@ -223,6 +226,24 @@ int Server::getThreads() {
 	return threads;
 }
 
+void Server::setMinimumPhaseHrtfLength(int length) {
+	minimum_phase_hrtf_length = length;
+}
+
+int Server::getMinimumPhaseHrtfLength() {
+	return minimum_phase_hrtf_length;
+}
+
+void Server::setHrtfGrid(float azimuthStep, float elevationStep) {
+	hrtf_grid_azimuth_step = azimuthStep;
+	hrtf_grid_elevation_step = elevationStep;
+}
+
+void Server::getHrtfGrid(float &azimuthStep, float &elevationStep) {
+	azimuthStep = hrtf_grid_azimuth_step;
+	elevationStep = hrtf_grid_elevation_step;
+}
+
 void Server::invalidatePlan() {
 	planner->invalidatePlan();
 }
@@ -345,6 +366,44 @@ Lav_PUBLIC_FUNCTION LavError Lav_serverGetThreads(LavHandle serverHandle, int* d
 	PUB_END
 }
 
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetMinimumPhaseHrtfLength(LavHandle serverHandle, int length) {
+	PUB_BEGIN
+	if(length < 0 || length > HRTF_MAX_MINIMUM_PHASE_LENGTH) ERROR(Lav_ERROR_RANGE, "The length must be from 0 to 1024.");
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->setMinimumPhaseHrtfLength(length);
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverGetMinimumPhaseHrtfLength(LavHandle serverHandle, int* destination) {
+	PUB_BEGIN
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	*destination = s->getMinimumPhaseHrtfLength();
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverSetHrtfGrid(LavHandle serverHandle, float azimuthStep, float elevationStep) {
+	PUB_BEGIN
+	for(float step: {azimuthStep, elevationStep}) {
+		if(isfinite(step) == false || (step != 0.0f && step < HRTF_MIN_GRID_STEP)) ERROR(Lav_ERROR_RANGE, "Grid steps must be 0 or at least 0.1 degrees.");
+	}
+	//Against the whole elevation range and the longest minimum phase length, so that any server setting fits.  HrtfData::buildGrid checks the real size again.
+	if(azimuthStep != 0.0f && elevationStep != 0.0f && computeHrtfGridSize(azimuthStep, elevationStep, 180.0f, HRTF_MAX_MINIMUM_PHASE_LENGTH) > HRTF_MAX_GRID_SIZE) ERROR(Lav_ERROR_RANGE, "The grid would be larger than 64 MB.");
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->setHrtfGrid(azimuthStep, elevationStep);
+	PUB_END
+}
+
+Lav_PUBLIC_FUNCTION LavError Lav_serverGetHrtfGrid(LavHandle serverHandle, float* destinationAzimuthStep, float* destinationElevationStep) {
+	PUB_BEGIN
+	auto s = incomingObject<Server>(serverHandle);
+	LOCK(*s);
+	s->getHrtfGrid(*destinationAzimuthStep, *destinationElevationStep);
+	PUB_END
+}
+
 Lav_PUBLIC_FUNCTION LavError Lav_serverCallIn(LavHandle serverHandle, double when, int inAudioThread, LavTimeCallback cb, void* userdata) {
 	PUB_BEGIN
 	auto s = incomingObject<Server>(serverHandle);
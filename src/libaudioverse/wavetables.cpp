@@ -0,0 +1,149 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+/**Builds and caches band-limited single-cycle tables for the additive oscillators.*/
+#include <libaudioverse/private/wavetables.hpp>
+#include <libaudioverse/private/constants.hpp>
+#include <libaudioverse/private/memory.hpp>
+#include <kiss_fftr.h>
+#include <math.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace libaudioverse_implementation {
+
+//The highest harmonic gets at least this many samples per cycle.
+//Linear interpolation then stays within about 1e-3 of the additive oscillators, even for the saw.
+const int samples_per_top_cycle = 32;
+const int min_wavetable_length = 4096;
+//Past this, we accept more interpolation error rather than using tens of megabytes per table.
+const int max_wavetable_length = 1<<20;
+
+//Returns the partial number of harmonic i (1-based), and its amplitude before normalization.
+static void additivePartial(AdditiveWaveforms waveform, int i, int* partial, double* amplitude) {
+	switch(waveform) {
+		case AdditiveWaveforms::SAW:
+		*partial = i;
+		*amplitude = -1.0/i;
+		break;
+		case AdditiveWaveforms::SQUARE:
+		*partial = 2*i-1;
+		*amplitude = 1.0/(2*i-1);
+		break;
+		case AdditiveWaveforms::TRIANGLE:
+		*partial = 2*i-1;
+		*amplitude = (i%2 ? 1.0 : -1.0)/((2*i-1)*(2*i-1));
+		break;
+	}
+}
+
+//These must match the normFactor computations in the additive oscillators.
+static double additiveNormFactor(AdditiveWaveforms waveform, int harmonics) {
+	if(harmonics <= 1) return 1.0;
+	switch(waveform) {
+		case AdditiveWaveforms::SAW: return 2*(1.0/(1.0+2*WILBRAHAM_GIBBS))*(1/PI);
+		case AdditiveWaveforms::SQUARE: return (4.0/PI)*(1.0/(1.0+2.0*WILBRAHAM_GIBBS))*(1.0/1.01);
+		case AdditiveWaveforms::TRIANGLE: return 8.0/(PI*PI);
+	}
+	return 1.0;
+}
+
+Wavetable::Wavetable(AdditiveWaveforms waveform, int harmonics): waveform(waveform), harmonics(harmonics) {
+	int topPartial, unused_partial;
+	double unused_amplitude;
+	additivePartial(waveform, harmonics, &topPartial, &unused_amplitude);
+	length = min_wavetable_length;
+	while(length < samples_per_top_cycle*topPartial && length < max_wavetable_length) length *= 2;
+	//Partials at or above nyquist of the table can't be represented, and only happen for absurd harmonic counts.
+	int representable = harmonics;
+	while(representable > 1) {
+		additivePartial(waveform, representable, &unused_partial, &unused_amplitude);
+		if(unused_partial < length/2) break;
+		representable--;
+	}
+	//We build the table with one inverse fft instead of summing sines at every point.
+	//The inverse fft of a bin with value -i*a/2 is a*sin(2*pi*partial*n/length).
+	int binCount = length/2+1;
+	kiss_fft_cpx* spectrum = allocArray<kiss_fft_cpx>(binCount);
+	for(int i = 1; i <= representable; i++) {
+		int partial;
+		double amplitude;
+		additivePartial(waveform, i, &partial, &amplitude);
+		spectrum[partial].i = (kiss_fft_scalar)(-amplitude/2.0);
+	}
+	data = allocArray<float>(length+1);
+	kiss_fftr_cfg ifft = kiss_fftr_alloc(length, 1, nullptr, nullptr);
+	kiss_fftri(ifft, spectrum, data);
+	kiss_fftr_free(ifft);
+	freeArray(spectrum);
+	float norm = (float)additiveNormFactor(waveform, harmonics);
+	for(int i = 0; i < length; i++) data[i] *= norm;
+	data[length] = data[0];
+}
+
+Wavetable::~Wavetable() {
+	freeArray(data);
+}
+
+WavetableMipmap::WavetableMipmap(AdditiveWaveforms waveform) {
+	for(int i = 0; i < WAVETABLE_MIPMAP_LEVELS; i++) levels.push_back(getAdditiveWavetable(waveform, 1<<i));
+}
+
+Wavetable* WavetableMipmap::getTableForHarmonics(int harmonics) {
+	int level = 0;
+	while(level+1 < WAVETABLE_MIPMAP_LEVELS && (2<<level) <= harmonics) level++;
+	return levels[level].get();
+}
+
+int computeAdditiveHarmonics(AdditiveWaveforms waveform, float sr, float frequency) {
+	double nyquist = sr/2.0;
+	frequency = fabsf(frequency);
+	//Avoid dividing by zero; a stopped oscillator may as well have all the harmonics we're willing to give it.
+	if(frequency == 0.0f) return 1<<(WAVETABLE_MIPMAP_LEVELS-1);
+	double harmonics;
+	if(waveform == AdditiveWaveforms::SAW) harmonics = nyquist/frequency;
+	else harmonics = 1+(nyquist-frequency)/(2*frequency);
+	return harmonics < 1.0 ? 1 : (int)std::min(harmonics, (double)(1<<(WAVETABLE_MIPMAP_LEVELS-1)));
+}
+
+std::map<std::tuple<AdditiveWaveforms, int>, std::shared_ptr<Wavetable>> *wavetable_cache;
+std::map<AdditiveWaveforms, std::shared_ptr<WavetableMipmap>> *wavetable_mipmap_cache;
+std::recursive_mutex *wavetable_cache_mutex;
+
+void initializeWavetableCaches() {
+	wavetable_cache = new std::map<std::tuple<AdditiveWaveforms, int>, std::shared_ptr<Wavetable>>();
+	wavetable_mipmap_cache = new std::map<AdditiveWaveforms, std::shared_ptr<WavetableMipmap>>();
+	wavetable_cache_mutex = new std::recursive_mutex();
+}
+
+void shutdownWavetableCaches() {
+	delete wavetable_mipmap_cache;
+	delete wavetable_cache;
+	delete wavetable_cache_mutex;
+}
+
+std::shared_ptr<Wavetable> getAdditiveWavetable(AdditiveWaveforms waveform, int harmonics) {
+	if(harmonics < 1) harmonics = 1;
+	std::lock_guard<std::recursive_mutex> guard(*wavetable_cache_mutex);
+	auto key = std::make_tuple(waveform, harmonics);
+	if(wavetable_cache->count(key)) return wavetable_cache->at(key);
+	auto t = std::make_shared<Wavetable>(waveform, harmonics);
+	(*wavetable_cache)[key] = t;
+	return t;
+}
+
+std::shared_ptr<WavetableMipmap> getAdditiveWavetableMipmap(AdditiveWaveforms waveform) {
+	//Recursive because building a mipmap fills the table cache.
+	std::lock_guard<std::recursive_mutex> guard(*wavetable_cache_mutex);
+	if(wavetable_mipmap_cache->count(waveform)) return wavetable_mipmap_cache->at(waveform);
+	auto m = std::make_shared<WavetableMipmap>(waveform);
+	(*wavetable_mipmap_cache)[waveform] = m;
+	return m;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+
+/**Compares BlockBiquadFilter against BiquadFilter::tick on noise, printing the maximum error relative to the peak output and the time taken by each.
+These are internal classes, so this is built from their sources rather than linked against the library.*/
+#include "time_helper.hpp"
+#include <libaudioverse/libaudioverse_properties.h>
+#include <libaudioverse/implementations/biquad.hpp>
+#include <libaudioverse/implementations/block_biquad.hpp>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <tuple>
+#include <algorithm>
+
+#define SR 44100
+//Odd so that the scalar tail is exercised.
+#define BLOCK_SIZE 1023
+//About 10 seconds.
+#define BLOCKS 431
+#define ITERATIONS 1000
+//Filters with poles near 1 see errors of a few parts in 10000 from single-precision coefficients alone; ticking in single precision does no better.
+#define ERROR_BOUND 1e-3f
+float input[BLOCK_SIZE], expected[BLOCK_SIZE], actual[BLOCK_SIZE];
+
+//type, frequency, dbgain, q.  The high shelves are the range used for occlusion.
+std::tuple<std::string, int, double, double, double> cases[] = {
+	std::make_tuple("identity", Lav_BIQUAD_TYPE_IDENTITY, 0.0, 0.0, 0.0),
+	std::make_tuple("light occlusion", Lav_BIQUAD_TYPE_HIGHSHELF, 900.0, -7.0, 0.5),
+	std::make_tuple("full occlusion", Lav_BIQUAD_TYPE_HIGHSHELF, 368.0, -70.0, 0.5),
+	std::make_tuple("lowpass 50 HZ", Lav_BIQUAD_TYPE_LOWPASS, 50.0, 0.0, 0.7),
+	std::make_tuple("lowpass 5000 HZ", Lav_BIQUAD_TYPE_LOWPASS, 5000.0, 0.0, 0.7),
+	std::make_tuple("highpass 100 HZ", Lav_BIQUAD_TYPE_HIGHPASS, 100.0, 0.0, 0.7),
+	std::make_tuple("peaking 1000 HZ", Lav_BIQUAD_TYPE_PEAKING, 1000.0, 12.0, 4.0),
+	std::make_tuple("bandpass 300 HZ", Lav_BIQUAD_TYPE_BANDPASS, 300.0, 0.0, 10.0),
+};
+
+int main(int argc, char** args) {
+	using namespace libaudioverse_implementation;
+	bool failed = false;
+	for(auto &c: cases) {
+		BiquadFilter reference(SR);
+		BlockBiquadFilter block(SR);
+		reference.configure(std::get<1>(c), std::get<2>(c), std::get<3>(c), std::get<4>(c));
+		block.configure(std::get<1>(c), std::get<2>(c), std::get<3>(c), std::get<4>(c));
+		srand(1234);
+		float maxError = 0.0f, peak = 0.0f;
+		for(int i = 0; i < BLOCKS; i++) {
+			for(int j = 0; j < BLOCK_SIZE; j++) input[j] = 2.0f*rand()/(float)RAND_MAX-1.0f;
+			for(int j = 0; j < BLOCK_SIZE; j++) expected[j] = reference.tick(input[j]);
+			block.process(BLOCK_SIZE, input, actual);
+			for(int j = 0; j < BLOCK_SIZE; j++) {
+				maxError = std::max(maxError, fabsf(expected[j]-actual[j]));
+				peak = std::max(peak, fabsf(expected[j]));
+			}
+		}
+		float relativeError = peak > 0.0f ? maxError/peak : maxError;
+		float tickTime = timeit([&] () {
+			for(int j = 0; j < BLOCK_SIZE; j++) expected[j] = reference.tick(input[j]);
+		}, ITERATIONS);
+		float blockTime = timeit([&] () {
+			block.process(BLOCK_SIZE, input, actual);
+		}, ITERATIONS);
+		printf("%s: relative error %g, tick %f seconds, block %f seconds\n", std::get<0>(c).c_str(), relativeError, tickTime, blockTime);
+		if(relativeError > ERROR_BOUND) failed = true;
+	}
+	if(failed) printf("Error bound of %g exceeded.\n", ERROR_BOUND);
+	return failed;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+/**Compares FftPlan against kissfft at each power of 2 used by the convolvers, printing the round trip error, the largest difference between the spectra relative to the peak bin, and the time for a forward and inverse transform with each.
+FftPlan is internal, so this is built from its sources rather than linked against the library.*/
+#include "time_helper.hpp"
+#include <libaudioverse/private/fft.hpp>
+#include <kiss_fftr.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#define MIN_SIZE 64
+#define MAX_SIZE 16384
+//Enough to do about 2^24 samples of transforms at each size.
+#define SAMPLES (1<<24)
+//Single precision; both libraries land around 1e-7 of the peak per pass.
+#define ERROR_BOUND 1e-5f
+
+int main(int argc, char** args) {
+	using namespace libaudioverse_implementation;
+	initializeFftPlanCache();
+	bool failed = false;
+	for(int size = MIN_SIZE; size <= MAX_SIZE; size *= 2) {
+		auto plan = getFftPlan(size);
+		int bins = plan->getBinCount();
+		std::vector<float> input(size), roundTrip(size), real(bins), imag(bins), kissOutput(size);
+		std::vector<kiss_fft_cpx> kissSpectrum(bins);
+		kiss_fftr_cfg kissForward = kiss_fftr_alloc(size, 0, nullptr, nullptr);
+		kiss_fftr_cfg kissInverse = kiss_fftr_alloc(size, 1, nullptr, nullptr);
+		srand(1234);
+		for(auto &i: input) i = 2.0f*rand()/(float)RAND_MAX-1.0f;
+		plan->forward(&input[0], &real[0], &imag[0]);
+		kiss_fftr(kissForward, &input[0], &kissSpectrum[0]);
+		float spectrumError = 0.0f, peak = 0.0f;
+		for(int i = 0; i < bins; i++) {
+			spectrumError = std::max(spectrumError, std::max(fabsf(real[i]-kissSpectrum[i].r), fabsf(imag[i]-kissSpectrum[i].i)));
+			peak = std::max(peak, std::max(fabsf(kissSpectrum[i].r), fabsf(kissSpectrum[i].i)));
+		}
+		plan->inverse(&real[0], &imag[0], &roundTrip[0]);
+		float roundTripError = 0.0f;
+		for(int i = 0; i < size; i++) roundTripError = std::max(roundTripError, fabsf(roundTrip[i]/size-input[i]));
+		int iterations = SAMPLES/size;
+		float planTime = timeit([&] () {
+			plan->forward(&input[0], &real[0], &imag[0]);
+			plan->inverse(&real[0], &imag[0], &roundTrip[0]);
+		}, iterations);
+		float kissTime = timeit([&] () {
+			kiss_fftr(kissForward, &input[0], &kissSpectrum[0]);
+			kiss_fftri(kissInverse, &kissSpectrum[0], &kissOutput[0]);
+		}, iterations);
+		printf("%i: round trip error %g, spectrum error %g, plan %f seconds, kiss %f seconds (%.2fx)\n", size, roundTripError, spectrumError/peak, planTime, kissTime, kissTime/planTime);
+		if(roundTripError > ERROR_BOUND || spectrumError/peak > ERROR_BOUND) failed = true;
+		kiss_fftr_free(kissForward);
+		kiss_fftr_free(kissInverse);
+	}
+	shutdownFftPlanCache();
+	if(failed) printf("Error bound of %g exceeded.\n", ERROR_BOUND);
+	return failed;
+}
\ No newline at end of file
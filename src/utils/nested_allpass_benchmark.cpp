@@ -0,0 +1,80 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+
+/**Runs a Schroeder-style nested allpass network through the AST interpreter, the compiled program a sample at a time, and the compiled program a block at a time.
+Prints the maximum difference from the interpreter and the time taken by each.
+NestedAllpassNetwork is internal, so this is built from its sources rather than linked against the library.*/
+#include "time_helper.hpp"
+#include <libaudioverse/libaudioverse_properties.h>
+#include <libaudioverse/implementations/nested_allpass_network.hpp>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+#define SR 44100
+#define BLOCK_SIZE 1024
+#define BLOCKS 100
+#define ITERATIONS 200
+//The block path reorders nothing, but the interpolated lines' reads go through a crossfade with weight 0.
+#define ERROR_BOUND 1e-5f
+float input[BLOCK_SIZE], expected[BLOCK_SIZE], ticked[BLOCK_SIZE], blocked[BLOCK_SIZE];
+
+void build(libaudioverse_implementation::NestedAllpassNetwork &n) {
+	n.appendAllpass(142, 0.7f);
+	n.appendAllpass(107, 0.7f);
+	n.beginNesting(379, 0.5f);
+	n.appendAllpass(277, 0.6f);
+	n.beginNesting(83, 0.4f);
+	n.appendOnePole(5000.0f);
+	n.endNesting();
+	n.appendReader(0.3f);
+	n.endNesting();
+	n.appendBiquad(Lav_BIQUAD_TYPE_LOWPASS, 3000.0, 0.0, 0.7);
+	n.appendReader(0.5f);
+	n.beginNesting(1051, 0.5f);
+	n.appendAllpass(337, 0.6f);
+	n.appendOnePole(200.0f, true);
+	n.endNesting();
+	n.appendReader(0.2f);
+	n.compile();
+}
+
+int main(int argc, char** args) {
+	using namespace libaudioverse_implementation;
+	NestedAllpassNetwork interpreted(SR), compiled(SR), block(SR);
+	build(interpreted);
+	build(compiled);
+	build(block);
+	srand(1234);
+	float tickError = 0.0f, blockError = 0.0f;
+	for(int i = 0; i < BLOCKS; i++) {
+		//Impulses every so often, so that the tails are exercised too.
+		for(int j = 0; j < BLOCK_SIZE; j++) input[j] = i%10 < 5 ? 2.0f*rand()/(float)RAND_MAX-1.0f : 0.0f;
+		for(int j = 0; j < BLOCK_SIZE; j++) expected[j] = interpreted.tickInterpreted(input[j]);
+		for(int j = 0; j < BLOCK_SIZE; j++) ticked[j] = compiled.tick(input[j]);
+		block.process(BLOCK_SIZE, input, blocked);
+		for(int j = 0; j < BLOCK_SIZE; j++) {
+			tickError = std::max(tickError, fabsf(expected[j]-ticked[j]));
+			blockError = std::max(blockError, fabsf(expected[j]-blocked[j]));
+		}
+	}
+	float interpretedTime = timeit([&] () {
+		for(int j = 0; j < BLOCK_SIZE; j++) expected[j] = interpreted.tickInterpreted(input[j]);
+	}, ITERATIONS);
+	float tickTime = timeit([&] () {
+		for(int j = 0; j < BLOCK_SIZE; j++) ticked[j] = compiled.tick(input[j]);
+	}, ITERATIONS);
+	float blockTime = timeit([&] () {
+		block.process(BLOCK_SIZE, input, blocked);
+	}, ITERATIONS);
+	printf("Maximum error: tick %g, block %g\n", tickError, blockError);
+	printf("Interpreted %f seconds, compiled tick %f seconds, compiled block %f seconds\n", interpretedTime, tickTime, blockTime);
+	bool failed = tickError > ERROR_BOUND || blockError > ERROR_BOUND;
+	if(failed) printf("Error bound of %g exceeded.\n", ERROR_BOUND);
+	return failed;
+}
\ No newline at end of file
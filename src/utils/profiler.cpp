@@ -16,7 +16,10 @@ If these files are unavailable to you, see either http://www.gnu.org/licenses/ (
 #include <string.h>
 #include <vector>
 #include <tuple>
+#include <string>
+#include <functional>
 
+//The default and the largest block size that can be profiled.
 #define BLOCK_SIZE 1024
 #define SR 44100
 #define ITERATIONS 200
@@ -63,9 +66,17 @@ LavError createBuffer(LavHandle s, LavHandle& h) {
 	return Lav_ERROR_NONE;
 }
 
+LavError createWavetableSaw(LavHandle s, LavHandle& h) {
+	ERRCHECK(Lav_createAdditiveSawNode(s, &h));
+	ERRCHECK(Lav_nodeSetIntProperty(h, Lav_ADDITIVE_OSCILLATOR_USE_WAVETABLE, 1));
+	return Lav_ERROR_NONE;
+}
+
 std::tuple<std::string, int, std::function<std::vector<LavHandle>(LavHandle, int)>> to_profile[] = {
 ENTRY("sine", 1000, Lav_createSineNode(s, &h)),
 ENTRY("Blit", 1000, Lav_createBlitNode(s, &h)),
+ENTRY("additive saw", 100, Lav_createAdditiveSawNode(s, &h)),
+ENTRY("wavetable saw", 1000, createWavetableSaw(s, h)),
 ENTRY("4-channel buffer", 100, createBuffer(s, h)),
 ENTRY("crossfading delay line", 1000, Lav_createCrossfadingDelayNode(s, 0.1, 1, &h)),
 ENTRY("biquad", 1000, Lav_createBiquadNode(s, 1, &h)),
@@ -84,21 +95,29 @@ ENTRY("32x32 FDN", 1, Lav_createFeedbackDelayNetworkNode(s, 1.0f, 32, &h)),
 int to_profile_size=sizeof(to_profile)/sizeof(to_profile[0]);
 
 int main(int argc, char** args) {
-	int threads = 1;
-	if(argc == 2) {
+	int threads = 1, blockSize = BLOCK_SIZE;
+	//Optionally a block size, so that the kernels specialized for each size can be compared.
+	if(argc >= 2) {
 		sscanf(args[1], "%i", &threads);
 		if(threads < 1) {
 			printf("Threads must be greater 1.\n");
 			return 1;
 		}
 	}
-	printf("Running profile tests on %i threads\n", threads);
+	if(argc >= 3) {
+		sscanf(args[2], "%i", &blockSize);
+		if(blockSize < 4 || blockSize > BLOCK_SIZE || blockSize%4) {
+			printf("Block size must be a multiple of 4 no greater than %i.\n", BLOCK_SIZE);
+			return 1;
+		}
+	}
+	printf("Running profile tests on %i threads with a block size of %i\n", threads, blockSize);
 	ERRCHECK(Lav_initialize());
 	for(int i = 0; i < to_profile_size; i++) {
 		auto &info = to_profile[i];
 		printf("Estimate for %s nodes: ", std::get<0>(info).c_str());
 		LavHandle s;
-		ERRCHECK(Lav_createServer(SR, BLOCK_SIZE, &s));
+		ERRCHECK(Lav_createServer(SR, blockSize, &s));
 		ERRCHECK(Lav_serverSetThreads(s, threads));
 		int times=std::get<1>(info);
 		//If it's not at least threads, make it threads.
@@ -111,7 +130,7 @@ int main(int argc, char** args) {
 			ERRCHECK(Lav_serverGetBlock(s, 2, 1, storage));
 		}, ITERATIONS);
 		dur /= ITERATIONS;
-		float estimate = (BLOCK_SIZE/(float)SR)/dur*times;
+		float estimate = (blockSize/(float)SR)/dur*times;
 		printf("%f\n", estimate);
 		for(auto h: handles) {
 			ERRCHECK(Lav_nodeDisconnect(h, 0, 0, 0));
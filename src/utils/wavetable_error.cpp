@@ -0,0 +1,95 @@
+/**Copyright (C) Austin Hicks, 2014-2016
+This file is part of Libaudioverse, a library for realtime audio applications.
+This code is dual-licensed.  It is released under the terms of the Mozilla Public License version 2.0 or the Gnu General Public License version 3 or later.
+You may use this code under the terms of either license at your option.
+A copy of both licenses may be found in license.gpl and license.mpl at the root of this repository.
+If these files are unavailable to you, see either http://www.gnu.org/licenses/ (GPL V3 or later) or https://www.mozilla.org/en-US/MPL/2.0/ (MPL 2.0).*/
+
+/**Compares the additive oscillators against their wavetable mode, printing the maximum error and the time taken by each.*/
+#include "time_helper.hpp"
+#include <libaudioverse/libaudioverse.h>
+#include <libaudioverse/libaudioverse_properties.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <tuple>
+
+#define BLOCK_SIZE 441
+#define SR 44100
+//0.1 seconds. The additive oscillators drift slowly as they run, so we keep this short.
+#define BLOCKS 10
+#define ITERATIONS 100
+#define ERROR_BOUND 0.002f
+float additive[BLOCK_SIZE], wavetable[BLOCK_SIZE];
+
+#define ERRCHECK(x) do {\
+if((x) != Lav_ERROR_NONE) {\
+	printf(#x " errored: %i", (x));\
+	Lav_shutdown();\
+	exit(1);\
+}\
+} while(0)\
+
+typedef LavError (*creator_t)(LavHandle, LavHandle*);
+
+std::tuple<std::string, creator_t, int> oscillators[] = {
+	std::make_tuple("saw", Lav_createAdditiveSawNode, Lav_SAW_HARMONICS),
+	std::make_tuple("square", Lav_createAdditiveSquareNode, Lav_SQUARE_HARMONICS),
+	std::make_tuple("triangle", Lav_createAdditiveTriangleNode, Lav_TRIANGLE_HARMONICS),
+};
+
+std::tuple<float, int> cases[] = {
+	std::make_tuple(20.0f, 500),
+	std::make_tuple(55.0f, 150),
+	std::make_tuple(440.0f, 25),
+	std::make_tuple(3000.0f, 3),
+};
+
+//The node is returned through node, and must outlive the server's use of it.
+LavHandle makeServer(creator_t creator, int harmonicsProperty, float frequency, int harmonics, bool useWavetable, LavHandle* node) {
+	LavHandle s, h;
+	ERRCHECK(Lav_createServer(SR, BLOCK_SIZE, &s));
+	ERRCHECK(creator(s, &h));
+	ERRCHECK(Lav_nodeSetFloatProperty(h, Lav_OSCILLATOR_FREQUENCY, frequency));
+	ERRCHECK(Lav_nodeSetIntProperty(h, harmonicsProperty, harmonics));
+	ERRCHECK(Lav_nodeSetIntProperty(h, Lav_ADDITIVE_OSCILLATOR_USE_WAVETABLE, useWavetable));
+	ERRCHECK(Lav_nodeConnectServer(h, 0));
+	*node = h;
+	return s;
+}
+
+int main(int argc, char** args) {
+	ERRCHECK(Lav_initialize());
+	bool failed = false;
+	for(auto &o: oscillators) {
+		for(auto &c: cases) {
+			float frequency = std::get<0>(c);
+			int harmonics = std::get<1>(c);
+			LavHandle an, wn;
+			LavHandle a = makeServer(std::get<1>(o), std::get<2>(o), frequency, harmonics, false, &an);
+			LavHandle w = makeServer(std::get<1>(o), std::get<2>(o), frequency, harmonics, true, &wn);
+			float maxError = 0.0f;
+			for(int i = 0; i < BLOCKS; i++) {
+				ERRCHECK(Lav_serverGetBlock(a, 1, 0, additive));
+				ERRCHECK(Lav_serverGetBlock(w, 1, 0, wavetable));
+				for(int j = 0; j < BLOCK_SIZE; j++) maxError = fmaxf(maxError, fabsf(additive[j]-wavetable[j]));
+			}
+			float additiveTime = timeit([&] () {
+				ERRCHECK(Lav_serverGetBlock(a, 1, 0, additive));
+			}, ITERATIONS);
+			float wavetableTime = timeit([&] () {
+				ERRCHECK(Lav_serverGetBlock(w, 1, 0, wavetable));
+			}, ITERATIONS);
+			printf("%s at %f HZ with %i harmonics: max error %f, additive %f seconds, wavetable %f seconds\n", std::get<0>(o).c_str(), frequency, harmonics, maxError, additiveTime, wavetableTime);
+			if(maxError > ERROR_BOUND) failed = true;
+			ERRCHECK(Lav_handleDecRef(an));
+			ERRCHECK(Lav_handleDecRef(wn));
+			ERRCHECK(Lav_handleDecRef(a));
+			ERRCHECK(Lav_handleDecRef(w));
+		}
+	}
+	Lav_shutdown();
+	if(failed) printf("Error bound of %f exceeded.\n", ERROR_BOUND);
+	return failed;
+}
\ No newline at end of file